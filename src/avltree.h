@@ -0,0 +1,502 @@
+/**
+ * @file  avltree.h
+ *
+ * @brief Self-balancing binary tree class (AVL tree).
+ */
+
+#ifndef _AVLTREE_H_
+
+#define _AVLTREE_H_
+
+#include <assert.h>
+#include <stddef.h>
+#include <utility>
+
+/// maximum tree height (AVL height < 1.45 * log2(n + 2), so 2^44 nodes)
+#define AVLTREE_HEIGHT_MAX 64
+
+/// AVL tree node structure
+template <typename T>
+struct avltree_node {
+    T                value;   ///< node value
+    avltree_node<T> *p_left;  ///< pointer to left child node
+    avltree_node<T> *p_right; ///< pointer to right child node
+    int              height;  ///< height of sub-tree rooted at node
+
+    /**
+     * @brief Constructor, constructing value in place.
+     *
+     * @param[in] p_left:  Pointer to left child node.
+     * @param[in] p_right: Pointer to right child node.
+     * @param[in] height:  Height of sub-tree rooted at node.
+     * @param[in] args:    Arguments for value's constructor.
+     */
+    template <typename... Args>
+    avltree_node(avltree_node<T> *p_left, avltree_node<T> *p_right,
+                 int height, Args &&... args) :
+        value(std::forward<Args>(args)...), p_left(p_left), p_right(p_right),
+        height(height)
+    {
+    }
+};
+
+/**
+ * @brief Self-balancing binary tree class (AVL tree).
+ *
+ * Same add/find/remove/depth/verify interface as btree, but after every add &
+ * remove, the heights of each node's sub-trees are kept within one of each
+ * other by rotations, so depth is O(log n) whatever the insertion order (e.g.
+ * sorted keys, which turn a btree into a linked list).
+ *
+ * add, find & remove are iterative: add & remove record the links they follow
+ * on a fixed-size path, which is walked back up to update heights & rebalance.
+ */
+template <typename T>
+class avltree
+{
+public:
+
+    /**
+     * @brief Constructor.
+     */
+    avltree()
+    {
+        p_root = NULL;
+
+        num_nodes = 0;
+    }
+
+    /**
+     * @brief Destructor.
+     */
+    ~avltree()
+    {
+        avltree_delete(p_root);
+    }
+
+    /**
+     * @brief Add node with associated value to tree.
+     *
+     * @param[in] value: Value.
+     */
+    void add(const T &value)
+    {
+        add_node(node_create(value));
+    }
+
+    /**
+     * @brief Add node with associated value to tree (moving value).
+     *
+     * @param[in,out] value: Value.
+     */
+    void add(T &&value)
+    {
+        add_node(node_create(std::move(value)));
+    }
+
+    /**
+     * @brief Add node to tree, constructing it's value in place.
+     *
+     * @param[in] args: Arguments for value's constructor.
+     */
+    template <typename... Args>
+    void emplace(Args &&... args)
+    {
+        add_node(node_create(std::forward<Args>(args)...));
+    }
+
+    /**
+     * @brief Find node with associated value.
+     *
+     * @param[in] p_node: Pointer to sub-tree's root node.
+     * @param[in] value:  Value.
+     *
+     * @retval NULL if node with associated value not found.
+     * @retval Pointer to node with associated value.
+     */
+    avltree_node<T> *find(avltree_node<T> *p_node, const T &value)
+    {
+        while ((p_node != NULL) && !(p_node->value == value))
+        {
+            p_node = (value < p_node->value) ? p_node->p_left :
+                                               p_node->p_right;
+        }
+
+        return p_node;
+    }
+
+    /**
+     * @brief Remove node with associated value.
+     *
+     * @param[in] value: Value.
+     *
+     * @retval  true if node with associated value removed.
+     * @retval false if node with associated value not removed.
+     */
+    bool remove(const T &value)
+    {
+        avltree_node<T> **path[AVLTREE_HEIGHT_MAX];
+        avltree_node<T>  *p_node;
+        avltree_node<T>  *p_successor;
+
+        int depth = 0;
+        int depth_node;
+
+        // find node, recording links followed
+
+        path[depth] = &p_root;
+
+        while ((*path[depth] != NULL) && !((*path[depth])->value == value))
+        {
+            p_node = *path[depth];
+
+            path[depth + 1] = (value < p_node->value) ? &p_node->p_left :
+                                                        &p_node->p_right;
+
+            depth++;
+        }
+
+        p_node = *path[depth];
+
+        if (p_node == NULL)
+        {
+            return false;
+        }
+
+        if ((p_node->p_left == NULL) || (p_node->p_right == NULL))
+        {
+            // node's only child (if any) replaces it
+
+            *path[depth] = (p_node->p_left != NULL) ? p_node->p_left :
+                                                      p_node->p_right;
+        }
+        else
+        {
+            // in-order successor (right sub-tree's left-most node) replaces it
+
+            depth_node = depth;
+
+            path[++depth] = &p_node->p_right;
+
+            while ((*path[depth])->p_left != NULL)
+            {
+                path[depth + 1] = &(*path[depth])->p_left;
+
+                depth++;
+            }
+
+            p_successor = *path[depth];
+
+            *path[depth] = p_successor->p_right;
+
+            p_successor->p_left  = p_node->p_left;
+            p_successor->p_right = p_node->p_right;
+            p_successor->height  = p_node->height;
+
+            *path[depth_node] = p_successor;
+
+            // link below node now belongs to successor
+
+            path[depth_node + 1] = &p_successor->p_right;
+        }
+
+        node_delete(p_node);
+
+        rebalance_path(path, depth);
+
+        return true;
+    }
+
+    /**
+     * @brief Get depth of sub-tree.
+     *
+     * @param[in] p_node: Pointer to sub-tree's root node.
+     *
+     * @retval Depth of sub-tree.
+     */
+    int depth(avltree_node<T> *p_node)
+    {
+        return height(p_node);
+    }
+
+    /**
+     * @brief Verify tree by traversing it in-order and checking that no element
+     *        is greater than it's predecessor, and that every node's height is
+     *        correct & balanced.
+     *
+     * @param[in] p_node:     Pointer to sub-tree's root node.
+     * @param[in] value_prev: Previous value.
+     *
+     * @retval  true if AVL tree is correct
+     * @retval false if AVL tree is incorrect
+     */
+    bool verify(avltree_node<T> *p_node, T value_prev)
+    {
+        return verify_subtree(p_node, &value_prev) >= 0;
+    }
+
+    avltree_node<T> *p_root; ///< pointer to root node
+
+private:
+
+    /**
+     * @brief Link new node into tree.
+     *
+     * @param[in,out] p_node_new: Pointer to new node structure.
+     */
+    void add_node(avltree_node<T> *p_node_new)
+    {
+        avltree_node<T> **path[AVLTREE_HEIGHT_MAX];
+
+        int depth = 0;
+
+        // find empty link, recording links followed
+
+        path[depth] = &p_root;
+
+        while (*path[depth] != NULL)
+        {
+            avltree_node<T> *p_node = *path[depth];
+
+            path[depth + 1] = (p_node_new->value < p_node->value) ?
+                              &p_node->p_left : &p_node->p_right;
+
+            depth++;
+
+            assert(depth < AVLTREE_HEIGHT_MAX);
+        }
+
+        *path[depth] = p_node_new;
+
+        rebalance_path(path, depth);
+    }
+
+    /**
+     * @brief Walk recorded path back up to root, updating heights &
+     *        rebalancing (stops early once a sub-tree's height is unchanged).
+     *
+     * @param[in,out] path:  Links followed from root (path[0] == &p_root).
+     * @param[in]     depth: Index of last link whose sub-tree changed.
+     */
+    void rebalance_path(avltree_node<T> **path[], int depth)
+    {
+        avltree_node<T> *p_node;
+
+        int height_old;
+
+        while (depth-- > 0)
+        {
+            p_node = *path[depth];
+
+            height_old = p_node->height;
+
+            *path[depth] = rebalance(p_node);
+
+            if ((*path[depth] == p_node) && (p_node->height == height_old))
+            {
+                break;
+            }
+        }
+    }
+
+    /**
+     * @brief Restore balance of node whose sub-trees' heights differ by at
+     *        most two, & update it's height.
+     *
+     * @param[in,out] p_node: Pointer to node structure.
+     *
+     * @retval Pointer to sub-tree's (possibly new) root node.
+     */
+    avltree_node<T> *rebalance(avltree_node<T> *p_node)
+    {
+        int balance = height(p_node->p_left) - height(p_node->p_right);
+
+        if (balance > 1)
+        {
+            if (height(p_node->p_left->p_left) <
+                height(p_node->p_left->p_right))
+            {
+                p_node->p_left = rotate_left(p_node->p_left);
+            }
+
+            return rotate_right(p_node);
+        }
+
+        if (balance < -1)
+        {
+            if (height(p_node->p_right->p_right) <
+                height(p_node->p_right->p_left))
+            {
+                p_node->p_right = rotate_right(p_node->p_right);
+            }
+
+            return rotate_left(p_node);
+        }
+
+        height_update(p_node);
+
+        return p_node;
+    }
+
+    /**
+     * @brief Rotate sub-tree left (right child becomes it's root).
+     *
+     * @param[in,out] p_node: Pointer to sub-tree's root node.
+     *
+     * @retval Pointer to sub-tree's new root node.
+     */
+    avltree_node<T> *rotate_left(avltree_node<T> *p_node)
+    {
+        avltree_node<T> *p_right = p_node->p_right;
+
+        p_node->p_right = p_right->p_left;
+
+        p_right->p_left = p_node;
+
+        height_update(p_node);
+        height_update(p_right);
+
+        return p_right;
+    }
+
+    /**
+     * @brief Rotate sub-tree right (left child becomes it's root).
+     *
+     * @param[in,out] p_node: Pointer to sub-tree's root node.
+     *
+     * @retval Pointer to sub-tree's new root node.
+     */
+    avltree_node<T> *rotate_right(avltree_node<T> *p_node)
+    {
+        avltree_node<T> *p_left = p_node->p_left;
+
+        p_node->p_left = p_left->p_right;
+
+        p_left->p_right = p_node;
+
+        height_update(p_node);
+        height_update(p_left);
+
+        return p_left;
+    }
+
+    /**
+     * @brief Get height of sub-tree.
+     *
+     * @param[in] p_node: Pointer to sub-tree's root node (may be NULL).
+     *
+     * @retval Height of sub-tree (0 if empty).
+     */
+    static int height(const avltree_node<T> *p_node)
+    {
+        return (p_node == NULL) ? 0 : p_node->height;
+    }
+
+    /**
+     * @brief Recompute node's height from it's children's heights.
+     *
+     * @param[in,out] p_node: Pointer to node structure.
+     */
+    static void height_update(avltree_node<T> *p_node)
+    {
+        int height_left  = height(p_node->p_left);
+        int height_right = height(p_node->p_right);
+
+        p_node->height = ((height_left > height_right) ? height_left :
+                                                         height_right) + 1;
+    }
+
+    /**
+     * @brief Recursively verify sub-tree (recursion depth is O(log n)).
+     *
+     * @param[in]     p_node:       Pointer to sub-tree's root node.
+     * @param[in,out] p_value_prev: Pointer to previous value in in-order.
+     *
+     * @retval -1 if sub-tree is incorrect
+     * @retval Height of sub-tree
+     */
+    int verify_subtree(avltree_node<T> *p_node, T *p_value_prev)
+    {
+        int height_left, height_right;
+
+        if (p_node == NULL)
+        {
+            return 0;
+        }
+
+        height_left = verify_subtree(p_node->p_left, p_value_prev);
+
+        if ((height_left < 0) || (p_node->value < *p_value_prev))
+        {
+            return -1;
+        }
+
+        *p_value_prev = p_node->value;
+
+        height_right = verify_subtree(p_node->p_right, p_value_prev);
+
+        if ((height_right < 0) ||
+            (height_left - height_right > 1) ||
+            (height_right - height_left > 1))
+        {
+            return -1;
+        }
+
+        if (p_node->height != ((height_left > height_right) ? height_left :
+                                                              height_right) + 1)
+        {
+            return -1;
+        }
+
+        return p_node->height;
+    }
+
+    /**
+     * @brief Create node, constructing it's value in place.
+     *
+     * @param[in] args: Arguments for value's constructor.
+     *
+     * @retval Pointer to new node structure.
+     */
+    template <typename... Args>
+    avltree_node<T> *node_create(Args &&... args)
+    {
+        num_nodes++;
+
+        return new avltree_node<T>(NULL, NULL, 1, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Delete node.
+     *
+     * @param[in,out] p_node: Pointer to node structure.
+     */
+    void node_delete(avltree_node<T> *p_node)
+    {
+        delete p_node;
+
+        num_nodes--;
+    }
+
+    /**
+     * @brief Recursively delete AVL tree using post-order traversal (recursion
+     *        depth is O(log n)).
+     *
+     * @param[in,out] p_node: Pointer to node structure (current sub-tree's
+     *                        root node).
+     */
+    void avltree_delete(avltree_node<T> *p_node)
+    {
+        if (p_node != NULL)
+        {
+            avltree_delete(p_node->p_left);
+            avltree_delete(p_node->p_right);
+
+            node_delete(p_node);
+        }
+    }
+
+    int num_nodes; ///< number of nodes in tree
+};
+
+#endif // #ifndef _AVLTREE_H_
@@ -0,0 +1,1156 @@
+/**
+ * @file  bptree.h
+ *
+ * @brief B+tree class.
+ */
+
+#ifndef _BPTREE_H_
+
+#define _BPTREE_H_
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <new>
+#include <utility>
+
+#define BPTREE_CACHE_LINE_SIZE 64 ///< cache line size in bytes
+
+#ifndef BPTREE_NODE_SIZE
+#define BPTREE_NODE_SIZE 256 ///< node size in bytes (multiple of cache line)
+#endif
+
+#define BPTREE_HEIGHT_MAX 32 ///< maximum number of inner node levels
+#define BPTREE_BATCH_SIZE 16 ///< number of lookups find_batch interleaves
+
+/// B+tree node structure (common part of leaves & inner nodes)
+template <typename T>
+struct bptree_node {
+    int num_keys; ///< number of keys in node
+};
+
+/// B+tree leaf node structure
+template <typename T>
+struct bptree_leaf : bptree_node<T> {
+    /// maximum number of keys per leaf
+    static const int capacity =
+        ((BPTREE_NODE_SIZE - 16) / (int)sizeof(T) > 3) ?
+        ((BPTREE_NODE_SIZE - 16) / (int)sizeof(T)) : 3;
+
+    T               keys[capacity]; ///< keys (sorted)
+    bptree_leaf<T> *p_next;         ///< pointer to next leaf (in key order)
+};
+
+/// B+tree inner node structure
+template <typename T>
+struct bptree_inner : bptree_node<T> {
+    /// maximum number of keys per inner node (one less than children)
+    static const int capacity =
+        ((BPTREE_NODE_SIZE - 16) / (int)(sizeof(T) + sizeof(void *)) > 3) ?
+        ((BPTREE_NODE_SIZE - 16) / (int)(sizeof(T) + sizeof(void *))) : 3;
+
+    T               keys[capacity];           ///< separator keys (sorted)
+    bptree_node<T> *p_children[capacity + 1]; ///< pointers to child nodes
+};
+
+/**
+ * @brief B+tree class.
+ *
+ * Same add/find/remove interface as btree (duplicate keys allowed), but keys
+ * are stored contiguously in nodes of BPTREE_NODE_SIZE bytes (with int keys:
+ * 60 per leaf, 20 per inner node with 21 children), so a lookup touches one
+ * node per level of a much shallower tree, and per-key overhead is a fraction
+ * of btree's two pointers. Only leaves hold keys; inner nodes hold separators
+ * (left sub-tree <= separator <= right sub-tree). Leaves are linked in key
+ * order for scans, starting at p_first.
+ *
+ * All operations are iterative; add & remove record the path they descend,
+ * which is walked back up to split (add) or borrow / merge (remove) nodes.
+ */
+template <typename T>
+class bptree
+{
+    typedef bptree_leaf<T>  leaf;  ///< leaf node type
+    typedef bptree_inner<T> inner; ///< inner node type
+
+    static const int LEAF_MIN  = leaf::capacity / 2;         ///< min leaf keys
+    static const int INNER_MIN = (inner::capacity - 1) / 2; ///< min inner keys
+
+public:
+
+    /**
+     * @brief Constructor.
+     */
+    bptree()
+    {
+        p_first = leaf_create();
+
+        p_root = p_first;
+
+        height = 0;
+
+        num_values = 0;
+    }
+
+    /**
+     * @brief Destructor.
+     */
+    ~bptree()
+    {
+        bptree_delete(p_root, height);
+    }
+
+    /**
+     * @brief Add key to tree.
+     *
+     * @param[in] value: Value.
+     */
+    void add(const T &value)
+    {
+        add_value(value);
+    }
+
+    /**
+     * @brief Add key to tree (moving value).
+     *
+     * @param[in,out] value: Value.
+     */
+    void add(T &&value)
+    {
+        add_value(std::move(value));
+    }
+
+    /**
+     * @brief Add key to tree, constructing it from arguments.
+     *
+     * Keys live in arrays that are shifted as keys come & go, so the key is
+     * constructed once here and then moved into it's slot.
+     *
+     * @param[in] args: Arguments for value's constructor.
+     */
+    template <typename... Args>
+    void emplace(Args &&... args)
+    {
+        add_value(T(std::forward<Args>(args)...));
+    }
+
+    /**
+     * @brief Find key.
+     *
+     * @param[in] value: Value.
+     *
+     * @retval NULL if key not found.
+     * @retval Pointer to (first) key equal to value.
+     */
+    const T *find(const T &value) const
+    {
+        bptree_node<T> *p_node = p_root;
+
+        int level;
+
+        for (level = height; level > 0; level--)
+        {
+            inner *p_inner = static_cast<inner *>(p_node);
+
+            p_node = p_inner->p_children[lower_bound(p_inner->keys,
+                                                     p_inner->num_keys,
+                                                     value)];
+        }
+
+        return leaf_find(static_cast<leaf *>(p_node), value);
+    }
+
+    /**
+     * @brief Find keys for a batch of values.
+     *
+     * Lookups are advanced in lock-step, BPTREE_BATCH_SIZE at a time: all
+     * leaves are at the same depth, so each round moves every lookup one
+     * level down & prefetches the whole node it moved to, so the cache
+     * misses of one round's lookups overlap instead of each lookup waiting
+     * for it's own misses in turn.
+     *
+     * @param[in]  p_values: Pointer to values.
+     * @param[in]  count:    Number of values.
+     * @param[out] pp_keys:  Pointer to found keys (NULL where not found).
+     */
+    void find_batch(const T *p_values, int count, const T **pp_keys) const
+    {
+        bptree_node<T> *p_nodes[BPTREE_BATCH_SIZE];
+
+        int first;
+        int num_lookups;
+        int level;
+        int ii;
+
+        for (first = 0; first < count; first += BPTREE_BATCH_SIZE)
+        {
+            num_lookups = (count - first < BPTREE_BATCH_SIZE) ?
+                          (count - first) : BPTREE_BATCH_SIZE;
+
+            for (ii = 0; ii < num_lookups; ii++)
+            {
+                p_nodes[ii] = p_root;
+            }
+
+            for (level = height; level > 0; level--)
+            {
+                for (ii = 0; ii < num_lookups; ii++)
+                {
+                    inner *p_inner = static_cast<inner *>(p_nodes[ii]);
+
+                    p_nodes[ii] =
+                        p_inner->p_children[lower_bound(p_inner->keys,
+                                                        p_inner->num_keys,
+                                                        p_values[first + ii])];
+
+                    node_prefetch(p_nodes[ii], (level > 1) ? sizeof(inner) :
+                                                             sizeof(leaf));
+                }
+            }
+
+            for (ii = 0; ii < num_lookups; ii++)
+            {
+                pp_keys[first + ii] =
+                    leaf_find(static_cast<leaf *>(p_nodes[ii]),
+                              p_values[first + ii]);
+            }
+        }
+    }
+
+    /**
+     * @brief Remove key.
+     *
+     * @param[in] value: Value.
+     *
+     * @retval  true if key removed.
+     * @retval false if key not found.
+     */
+    bool remove(const T &value)
+    {
+        inner *path[BPTREE_HEIGHT_MAX];
+        int    indices[BPTREE_HEIGHT_MAX];
+
+        leaf *p_leaf;
+
+        int index;
+        int ii;
+
+        p_leaf = descend(value, path, indices, true);
+
+        index = lower_bound(p_leaf->keys, p_leaf->num_keys, value);
+
+        if ((index == p_leaf->num_keys) && (p_leaf->p_next != NULL))
+        {
+            // equal keys only continue in next leaf: move path there
+
+            p_leaf = path_next(path, indices);
+
+            index = 0;
+        }
+
+        if ((index == p_leaf->num_keys) || !(p_leaf->keys[index] == value))
+        {
+            return false;
+        }
+
+        for (ii = index; ii < p_leaf->num_keys - 1; ii++)
+        {
+            p_leaf->keys[ii] = std::move(p_leaf->keys[ii + 1]);
+        }
+
+        p_leaf->num_keys--;
+
+        num_values--;
+
+        if ((height > 0) && (p_leaf->num_keys < LEAF_MIN))
+        {
+            leaf_underflow(path, indices, p_leaf);
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Get depth of tree (number of levels).
+     *
+     * @retval Depth of tree.
+     */
+    int depth() const
+    {
+        return height + 1;
+    }
+
+    /**
+     * @brief Get number of keys in tree.
+     *
+     * @retval Number of keys.
+     */
+    int size() const
+    {
+        return num_values;
+    }
+
+    /**
+     * @brief Is tree empty?
+     *
+     * @retval  true if tree is empty
+     * @retval false if tree is not empty
+     */
+    bool is_empty() const
+    {
+        return (num_values == 0) ? true : false;
+    }
+
+    /**
+     * @brief Verify tree: keys sorted & within their separators, nodes filled
+     *        at least half (except root), all leaves at same depth & linked in
+     *        order, and number of keys correct.
+     *
+     * @retval  true if B+tree is correct
+     * @retval false if B+tree is incorrect
+     */
+    bool verify() const
+    {
+        leaf *p_next = p_first;
+
+        int count = 0;
+
+        if (verify_subtree(p_root, height, NULL, NULL, &p_next, &count) ==
+            false)
+        {
+            return false;
+        }
+
+        return (p_next == NULL) && (count == num_values);
+    }
+
+    bptree_node<T> *p_root;  ///< pointer to root node
+    bptree_leaf<T> *p_first; ///< pointer to first leaf
+
+private:
+
+    /**
+     * @brief Add key to tree.
+     *
+     * @param[in] value: Value (const T & or T &&).
+     */
+    template <typename U>
+    void add_value(U &&value)
+    {
+        inner *path[BPTREE_HEIGHT_MAX];
+        int    indices[BPTREE_HEIGHT_MAX];
+
+        leaf *p_leaf;
+        leaf *p_right;
+
+        int index;
+        int level;
+
+        p_leaf = descend(value, path, indices, false);
+
+        index = upper_bound(p_leaf->keys, p_leaf->num_keys, value);
+
+        num_values++;
+
+        if (p_leaf->num_keys < leaf::capacity)
+        {
+            leaf_insert(p_leaf, index, std::forward<U>(value));
+
+            return;
+        }
+
+        // split leaf: left half stays, right half moves to new leaf
+
+        p_right = leaf_split(p_leaf, index, std::forward<U>(value));
+
+        // insert separator & new node into parents, splitting them as needed
+
+        T               separator = p_right->keys[0];
+        bptree_node<T> *p_child   = p_right;
+
+        for (level = height - 1; level >= 0; level--)
+        {
+            if (path[level]->num_keys < inner::capacity)
+            {
+                inner_insert(path[level], indices[level], std::move(separator),
+                             p_child);
+
+                return;
+            }
+
+            p_child = inner_split(path[level], indices[level], &separator,
+                                  p_child);
+        }
+
+        // root split: grow new root
+
+        inner *p_root_new = inner_create();
+
+        p_root_new->num_keys      = 1;
+        p_root_new->keys[0]       = std::move(separator);
+        p_root_new->p_children[0] = p_root;
+        p_root_new->p_children[1] = p_child;
+
+        p_root = p_root_new;
+
+        height++;
+
+        assert(height < BPTREE_HEIGHT_MAX);
+    }
+
+    /**
+     * @brief Descend from root to leaf, recording inner nodes & child indices.
+     *
+     * @param[in]  value:   Value.
+     * @param[out] path:    Inner nodes (path[0] is root).
+     * @param[out] indices: Child index taken at each inner node.
+     * @param[in]  left:    true: go left of equal separators (first equal
+     *                      key); false: go right (after last equal key).
+     *
+     * @retval Pointer to leaf.
+     */
+    leaf *descend(const T &value, inner *path[], int indices[], bool left)
+    {
+        bptree_node<T> *p_node = p_root;
+
+        int level;
+
+        for (level = 0; level < height; level++)
+        {
+            inner *p_inner = static_cast<inner *>(p_node);
+
+            path[level] = p_inner;
+
+            indices[level] = left ?
+                             lower_bound(p_inner->keys, p_inner->num_keys,
+                                         value) :
+                             upper_bound(p_inner->keys, p_inner->num_keys,
+                                         value);
+
+            p_node = p_inner->p_children[indices[level]];
+        }
+
+        return static_cast<leaf *>(p_node);
+    }
+
+    /**
+     * @brief Move recorded path to next leaf.
+     *
+     * @param[in,out] path:    Inner nodes (path[0] is root).
+     * @param[in,out] indices: Child index taken at each inner node.
+     *
+     * @retval Pointer to next leaf.
+     */
+    leaf *path_next(inner *path[], int indices[])
+    {
+        bptree_node<T> *p_node;
+
+        int level = height - 1;
+
+        // go up to first inner node with a child to the right
+
+        while (indices[level] == path[level]->num_keys)
+        {
+            level--;
+
+            assert(level >= 0);
+        }
+
+        indices[level]++;
+
+        p_node = path[level]->p_children[indices[level]];
+
+        // go down left-most children
+
+        for (level++; level < height; level++)
+        {
+            path[level] = static_cast<inner *>(p_node);
+
+            indices[level] = 0;
+
+            p_node = path[level]->p_children[0];
+        }
+
+        return static_cast<leaf *>(p_node);
+    }
+
+    /**
+     * @brief Insert key into (non-full) leaf.
+     *
+     * @param[in,out] p_leaf: Pointer to leaf.
+     * @param[in]     index:  Key index.
+     * @param[in]     value:  Value (const T & or T &&).
+     */
+    template <typename U>
+    static void leaf_insert(leaf *p_leaf, int index, U &&value)
+    {
+        int ii;
+
+        for (ii = p_leaf->num_keys; ii > index; ii--)
+        {
+            p_leaf->keys[ii] = std::move(p_leaf->keys[ii - 1]);
+        }
+
+        p_leaf->keys[index] = std::forward<U>(value);
+
+        p_leaf->num_keys++;
+    }
+
+    /**
+     * @brief Split full leaf & insert key into the proper half.
+     *
+     * @param[in,out] p_leaf: Pointer to (full) leaf.
+     * @param[in]     index:  Key index.
+     * @param[in]     value:  Value (const T & or T &&).
+     *
+     * @retval Pointer to new (right) leaf.
+     */
+    template <typename U>
+    leaf *leaf_split(leaf *p_leaf, int index, U &&value)
+    {
+        leaf *p_right = leaf_create();
+
+        int num_left = (leaf::capacity + 1) / 2; // after insertion
+        int first;
+        int ii;
+
+        // keys from 'first' on move right; value then goes where it belongs
+
+        first = (index < num_left) ? (num_left - 1) : num_left;
+
+        for (ii = first; ii < leaf::capacity; ii++)
+        {
+            p_right->keys[ii - first] = std::move(p_leaf->keys[ii]);
+        }
+
+        p_right->num_keys = leaf::capacity - first;
+        p_leaf->num_keys  = first;
+
+        if (index < num_left)
+        {
+            leaf_insert(p_leaf, index, std::forward<U>(value));
+        }
+        else
+        {
+            leaf_insert(p_right, index - first, std::forward<U>(value));
+        }
+
+        p_right->p_next = p_leaf->p_next;
+
+        p_leaf->p_next = p_right;
+
+        return p_right;
+    }
+
+    /**
+     * @brief Insert separator & right child into (non-full) inner node.
+     *
+     * @param[in,out] p_inner:   Pointer to inner node.
+     * @param[in]     index:     Index of child that was split.
+     * @param[in]     separator: Separator key.
+     * @param[in]     p_child:   Pointer to new child (right of separator).
+     */
+    static void inner_insert(inner *p_inner, int index, T &&separator,
+                             bptree_node<T> *p_child)
+    {
+        int ii;
+
+        for (ii = p_inner->num_keys; ii > index; ii--)
+        {
+            p_inner->keys[ii]           = std::move(p_inner->keys[ii - 1]);
+            p_inner->p_children[ii + 1] = p_inner->p_children[ii];
+        }
+
+        p_inner->keys[index]           = std::move(separator);
+        p_inner->p_children[index + 1] = p_child;
+
+        p_inner->num_keys++;
+    }
+
+    /**
+     * @brief Split full inner node while inserting separator & right child;
+     *        middle key moves up.
+     *
+     * @param[in,out] p_inner:     Pointer to (full) inner node.
+     * @param[in]     index:       Index of child that was split.
+     * @param[in,out] p_separator: Pointer to separator key (in: key to
+     *                             insert, out: key to insert into parent).
+     * @param[in]     p_child:     Pointer to new child (right of separator).
+     *
+     * @retval Pointer to new (right) inner node.
+     */
+    inner *inner_split(inner *p_inner, int index, T *p_separator,
+                       bptree_node<T> *p_child)
+    {
+        T               keys[inner::capacity + 1];
+        bptree_node<T> *p_children[inner::capacity + 2];
+
+        inner *p_right = inner_create();
+
+        int num_left = (inner::capacity + 1) / 2;
+        int ii, jj;
+
+        // merge node's keys & children with new ones
+
+        for (ii = 0, jj = 0; ii <= inner::capacity; ii++)
+        {
+            if (ii == index)
+            {
+                keys[ii] = std::move(*p_separator);
+            }
+            else
+            {
+                keys[ii] = std::move(p_inner->keys[jj++]);
+            }
+        }
+
+        for (ii = 0, jj = 0; ii <= inner::capacity + 1; ii++)
+        {
+            if (ii == index + 1)
+            {
+                p_children[ii] = p_child;
+            }
+            else
+            {
+                p_children[ii] = p_inner->p_children[jj++];
+            }
+        }
+
+        // left: keys [0, num_left), middle key moves up, right: the rest
+
+        for (ii = 0; ii < num_left; ii++)
+        {
+            p_inner->keys[ii]       = std::move(keys[ii]);
+            p_inner->p_children[ii] = p_children[ii];
+        }
+
+        p_inner->p_children[num_left] = p_children[num_left];
+
+        p_inner->num_keys = num_left;
+
+        *p_separator = std::move(keys[num_left]);
+
+        for (ii = num_left + 1; ii <= inner::capacity; ii++)
+        {
+            p_right->keys[ii - num_left - 1]       = std::move(keys[ii]);
+            p_right->p_children[ii - num_left - 1] = p_children[ii];
+        }
+
+        p_right->p_children[inner::capacity - num_left] =
+            p_children[inner::capacity + 1];
+
+        p_right->num_keys = inner::capacity - num_left;
+
+        return p_right;
+    }
+
+    /**
+     * @brief Refill leaf that fell below minimum: borrow key from sibling if
+     *        it can spare one, else merge with sibling (& fix parents).
+     *
+     * @param[in,out] path:    Inner nodes (path[0] is root).
+     * @param[in,out] indices: Child index taken at each inner node.
+     * @param[in,out] p_leaf:  Pointer to leaf.
+     */
+    void leaf_underflow(inner *path[], int indices[], leaf *p_leaf)
+    {
+        inner *p_parent = path[height - 1];
+
+        int index = indices[height - 1];
+        int ii;
+
+        leaf *p_left  = (index > 0) ?
+                        static_cast<leaf *>(p_parent->p_children[index - 1]) :
+                        NULL;
+        leaf *p_right = (index < p_parent->num_keys) ?
+                        static_cast<leaf *>(p_parent->p_children[index + 1]) :
+                        NULL;
+
+        if ((p_left != NULL) && (p_left->num_keys > LEAF_MIN))
+        {
+            // borrow left sibling's last key
+
+            leaf_insert(p_leaf, 0, std::move(p_left->keys[--p_left->num_keys]));
+
+            p_parent->keys[index - 1] = p_leaf->keys[0];
+        }
+        else if ((p_right != NULL) && (p_right->num_keys > LEAF_MIN))
+        {
+            // borrow right sibling's first key
+
+            p_leaf->keys[p_leaf->num_keys++] = std::move(p_right->keys[0]);
+
+            for (ii = 0; ii < p_right->num_keys - 1; ii++)
+            {
+                p_right->keys[ii] = std::move(p_right->keys[ii + 1]);
+            }
+
+            p_right->num_keys--;
+
+            p_parent->keys[index] = p_right->keys[0];
+        }
+        else
+        {
+            // merge right one of the pair into left one
+
+            if (p_left == NULL)
+            {
+                p_left = p_leaf;
+            }
+            else
+            {
+                p_right = p_leaf;
+
+                index--;
+            }
+
+            for (ii = 0; ii < p_right->num_keys; ii++)
+            {
+                p_left->keys[p_left->num_keys++] = std::move(p_right->keys[ii]);
+            }
+
+            p_left->p_next = p_right->p_next;
+
+            leaf_delete(p_right);
+
+            inner_remove(path, indices, height - 1, index);
+        }
+    }
+
+    /**
+     * @brief Remove separator & child right of it from inner node, then
+     *        refill node if it fell below minimum (walking up path).
+     *
+     * @param[in,out] path:    Inner nodes (path[0] is root).
+     * @param[in,out] indices: Child index taken at each inner node.
+     * @param[in]     level:   Level of inner node.
+     * @param[in]     index:   Index of separator.
+     */
+    void inner_remove(inner *path[], int indices[], int level, int index)
+    {
+        inner *p_inner = path[level];
+        inner *p_parent;
+        inner *p_left;
+        inner *p_right;
+
+        int ii;
+
+        for (ii = index; ii < p_inner->num_keys - 1; ii++)
+        {
+            p_inner->keys[ii]           = std::move(p_inner->keys[ii + 1]);
+            p_inner->p_children[ii + 1] = p_inner->p_children[ii + 2];
+        }
+
+        p_inner->num_keys--;
+
+        if (level == 0)
+        {
+            if (p_inner->num_keys == 0)
+            {
+                // root has single child: shrink tree
+
+                p_root = p_inner->p_children[0];
+
+                inner_delete(p_inner);
+
+                height--;
+            }
+
+            return;
+        }
+
+        if (p_inner->num_keys >= INNER_MIN)
+        {
+            return;
+        }
+
+        p_parent = path[level - 1];
+
+        index = indices[level - 1];
+
+        p_left  = (index > 0) ?
+                  static_cast<inner *>(p_parent->p_children[index - 1]) : NULL;
+        p_right = (index < p_parent->num_keys) ?
+                  static_cast<inner *>(p_parent->p_children[index + 1]) : NULL;
+
+        if ((p_left != NULL) && (p_left->num_keys > INNER_MIN))
+        {
+            // rotate left sibling's last key through parent
+
+            p_inner->p_children[p_inner->num_keys + 1] =
+                p_inner->p_children[p_inner->num_keys];
+
+            for (ii = p_inner->num_keys; ii > 0; ii--)
+            {
+                p_inner->keys[ii]       = std::move(p_inner->keys[ii - 1]);
+                p_inner->p_children[ii] = p_inner->p_children[ii - 1];
+            }
+
+            p_inner->keys[0]       = std::move(p_parent->keys[index - 1]);
+            p_inner->p_children[0] = p_left->p_children[p_left->num_keys];
+
+            p_inner->num_keys++;
+
+            p_parent->keys[index - 1] =
+                std::move(p_left->keys[p_left->num_keys - 1]);
+
+            p_left->num_keys--;
+        }
+        else if ((p_right != NULL) && (p_right->num_keys > INNER_MIN))
+        {
+            // rotate right sibling's first key through parent
+
+            p_inner->keys[p_inner->num_keys] = std::move(p_parent->keys[index]);
+
+            p_inner->p_children[p_inner->num_keys + 1] =
+                p_right->p_children[0];
+
+            p_inner->num_keys++;
+
+            p_parent->keys[index] = std::move(p_right->keys[0]);
+
+            for (ii = 0; ii < p_right->num_keys - 1; ii++)
+            {
+                p_right->keys[ii]       = std::move(p_right->keys[ii + 1]);
+                p_right->p_children[ii] = p_right->p_children[ii + 1];
+            }
+
+            p_right->p_children[p_right->num_keys - 1] =
+                p_right->p_children[p_right->num_keys];
+
+            p_right->num_keys--;
+        }
+        else
+        {
+            // merge right one of the pair into left one, pulling separator
+            // down from parent
+
+            if (p_left == NULL)
+            {
+                p_left = p_inner;
+            }
+            else
+            {
+                p_right = p_inner;
+
+                index--;
+            }
+
+            p_left->keys[p_left->num_keys] = std::move(p_parent->keys[index]);
+
+            for (ii = 0; ii < p_right->num_keys; ii++)
+            {
+                p_left->keys[p_left->num_keys + 1 + ii] =
+                    std::move(p_right->keys[ii]);
+
+                p_left->p_children[p_left->num_keys + 1 + ii] =
+                    p_right->p_children[ii];
+            }
+
+            p_left->p_children[p_left->num_keys + 1 + p_right->num_keys] =
+                p_right->p_children[p_right->num_keys];
+
+            p_left->num_keys += 1 + p_right->num_keys;
+
+            inner_delete(p_right);
+
+            inner_remove(path, indices, level - 1, index);
+        }
+    }
+
+    /**
+     * @brief Recursively verify sub-tree (recursion depth is tree's height).
+     *
+     * @param[in]     p_node:  Pointer to sub-tree's root node.
+     * @param[in]     level:   Sub-tree's height (0: leaf).
+     * @param[in]     p_lower: Pointer to lower bound (NULL: none).
+     * @param[in]     p_upper: Pointer to upper bound (NULL: none).
+     * @param[in,out] pp_next: Pointer to pointer to next leaf expected.
+     * @param[in,out] p_count: Pointer to number of keys seen.
+     *
+     * @retval  true if sub-tree is correct
+     * @retval false if sub-tree is incorrect
+     */
+    bool verify_subtree(bptree_node<T> *p_node, int level, const T *p_lower,
+                        const T *p_upper, leaf **pp_next, int *p_count) const
+    {
+        const T *p_keys;
+
+        int num_min;
+        int ii;
+
+        if (level == 0)
+        {
+            leaf *p_leaf = static_cast<leaf *>(p_node);
+
+            if (p_leaf != *pp_next)
+            {
+                return false;
+            }
+
+            *pp_next = p_leaf->p_next;
+
+            *p_count += p_leaf->num_keys;
+
+            p_keys  = p_leaf->keys;
+            num_min = (p_node == p_root) ? 0 : LEAF_MIN;
+        }
+        else
+        {
+            p_keys  = static_cast<inner *>(p_node)->keys;
+            num_min = (p_node == p_root) ? 1 : INNER_MIN;
+        }
+
+        if (p_node->num_keys < num_min)
+        {
+            return false;
+        }
+
+        for (ii = 0; ii < p_node->num_keys; ii++)
+        {
+            if (((ii > 0) && (p_keys[ii] < p_keys[ii - 1])) ||
+                ((p_lower != NULL) && (p_keys[ii] < *p_lower)) ||
+                ((p_upper != NULL) && (*p_upper < p_keys[ii])))
+            {
+                return false;
+            }
+        }
+
+        if (level == 0)
+        {
+            return true;
+        }
+
+        for (ii = 0; ii <= p_node->num_keys; ii++)
+        {
+            if (verify_subtree(static_cast<inner *>(p_node)->p_children[ii],
+                               level - 1,
+                               (ii > 0) ? &p_keys[ii - 1] : p_lower,
+                               (ii < p_node->num_keys) ? &p_keys[ii] : p_upper,
+                               pp_next, p_count) == false)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Find first key not less than value (binary search).
+     *
+     * @param[in] p_keys:   Pointer to keys (sorted).
+     * @param[in] num_keys: Number of keys.
+     * @param[in] value:    Value.
+     *
+     * @retval Index of first key >= value (num_keys if none).
+     */
+    static int lower_bound(const T *p_keys, int num_keys, const T &value)
+    {
+        int first = 0;
+        int half;
+
+        while (num_keys > 0)
+        {
+            half = num_keys / 2;
+
+            if (p_keys[first + half] < value)
+            {
+                first += half + 1;
+
+                num_keys -= half + 1;
+            }
+            else
+            {
+                num_keys = half;
+            }
+        }
+
+        return first;
+    }
+
+    /**
+     * @brief Find key in leaf (the one a descent for value ends at).
+     *
+     * @param[in] p_leaf: Pointer to leaf.
+     * @param[in] value:  Value.
+     *
+     * @retval NULL if key not found.
+     * @retval Pointer to (first) key equal to value.
+     */
+    static const T *leaf_find(const leaf *p_leaf, const T &value)
+    {
+        int index = lower_bound(p_leaf->keys, p_leaf->num_keys, value);
+
+        if ((index == p_leaf->num_keys) && (p_leaf->p_next != NULL))
+        {
+            // equal keys only continue in next leaf
+
+            p_leaf = p_leaf->p_next;
+
+            index = 0;
+        }
+
+        if ((index < p_leaf->num_keys) && (p_leaf->keys[index] == value))
+        {
+            return &p_leaf->keys[index];
+        }
+
+        return NULL;
+    }
+
+    /**
+     * @brief Prefetch every cache line of node.
+     *
+     * @param[in] p_node: Pointer to node.
+     * @param[in] size:   Node size in bytes.
+     */
+    static void node_prefetch(const bptree_node<T> *p_node, size_t size)
+    {
+        size_t offset;
+
+        for (offset = 0; offset < size;
+             offset += BPTREE_CACHE_LINE_SIZE)
+        {
+            __builtin_prefetch((const char *)p_node + offset);
+        }
+    }
+
+    /**
+     * @brief Find first key greater than value (binary search).
+     *
+     * @param[in] p_keys:   Pointer to keys (sorted).
+     * @param[in] num_keys: Number of keys.
+     * @param[in] value:    Value.
+     *
+     * @retval Index of first key > value (num_keys if none).
+     */
+    static int upper_bound(const T *p_keys, int num_keys, const T &value)
+    {
+        int first = 0;
+        int half;
+
+        while (num_keys > 0)
+        {
+            half = num_keys / 2;
+
+            if (!(value < p_keys[first + half]))
+            {
+                first += half + 1;
+
+                num_keys -= half + 1;
+            }
+            else
+            {
+                num_keys = half;
+            }
+        }
+
+        return first;
+    }
+
+    /**
+     * @brief Allocate (cache line aligned) node.
+     *
+     * @param[in] size: Node size in bytes.
+     *
+     * @retval Pointer to node memory.
+     */
+    static void *node_alloc(size_t size)
+    {
+        void *p_memory = NULL;
+
+        if (posix_memalign(&p_memory, BPTREE_CACHE_LINE_SIZE, size) != 0)
+        {
+            throw std::bad_alloc();
+        }
+
+        return p_memory;
+    }
+
+    /**
+     * @brief Create (empty) leaf.
+     *
+     * @retval Pointer to new leaf structure.
+     */
+    static leaf *leaf_create()
+    {
+        leaf *p_leaf = new (node_alloc(sizeof(leaf))) leaf;
+
+        p_leaf->num_keys = 0;
+
+        p_leaf->p_next = NULL;
+
+        return p_leaf;
+    }
+
+    /**
+     * @brief Create (empty) inner node.
+     *
+     * @retval Pointer to new inner node structure.
+     */
+    static inner *inner_create()
+    {
+        inner *p_inner = new (node_alloc(sizeof(inner))) inner;
+
+        p_inner->num_keys = 0;
+
+        return p_inner;
+    }
+
+    /**
+     * @brief Delete leaf.
+     *
+     * @param[in,out] p_leaf: Pointer to leaf structure.
+     */
+    static void leaf_delete(leaf *p_leaf)
+    {
+        p_leaf->~leaf();
+
+        free(p_leaf);
+    }
+
+    /**
+     * @brief Delete inner node.
+     *
+     * @param[in,out] p_inner: Pointer to inner node structure.
+     */
+    static void inner_delete(inner *p_inner)
+    {
+        p_inner->~inner();
+
+        free(p_inner);
+    }
+
+    /**
+     * @brief Recursively delete sub-tree (recursion depth is tree's height).
+     *
+     * @param[in,out] p_node: Pointer to sub-tree's root node.
+     * @param[in]     level:  Sub-tree's height (0: leaf).
+     */
+    static void bptree_delete(bptree_node<T> *p_node, int level)
+    {
+        int ii;
+
+        if (level == 0)
+        {
+            leaf_delete(static_cast<leaf *>(p_node));
+
+            return;
+        }
+
+        inner *p_inner = static_cast<inner *>(p_node);
+
+        for (ii = 0; ii <= p_inner->num_keys; ii++)
+        {
+            bptree_delete(p_inner->p_children[ii], level - 1);
+        }
+
+        inner_delete(p_inner);
+    }
+
+    int height;     ///< number of inner node levels (0: root is leaf)
+    int num_values; ///< number of keys in tree
+};
+
+#endif // #ifndef _BPTREE_H_
@@ -8,20 +8,149 @@
 
 #define _BTREE_H_
 
+#include <assert.h>
+#include <stddef.h>
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+
+#include "pool.h"
+
+#define BTREE_SORT_CHUNK_MIN 4096 ///< minimum number of values per sort thread
+#define BTREE_BUILD_STACK    64   ///< build's range stack size (>= depth + 1)
+#define BTREE_BATCH_SIZE     16   ///< number of lookups find_batch interleaves
+
+template <typename T> class eytzinger;
+
 /// binary tree node structure
 template <typename T>
 struct btree_node {
-    T              value;   ///< node value
-    btree_node<T> *p_left;  ///< pointer to left child node
-    btree_node<T> *p_right; ///< pointer to right child node
+    T              value;    ///< node value
+    btree_node<T> *p_left;   ///< pointer to left child node
+    btree_node<T> *p_right;  ///< pointer to right child node
+    btree_node<T> *p_parent; ///< pointer to parent node
+    int            size;     ///< number of nodes in sub-tree rooted at node
+
+    /**
+     * @brief Constructor, constructing value in place.
+     *
+     * @param[in] p_left:   Pointer to left child node.
+     * @param[in] p_right:  Pointer to right child node.
+     * @param[in] p_parent: Pointer to parent node.
+     * @param[in] size:     Number of nodes in sub-tree rooted at node.
+     * @param[in] args:     Arguments for value's constructor.
+     */
+    template <typename... Args>
+    btree_node(btree_node<T> *p_left, btree_node<T> *p_right,
+               btree_node<T> *p_parent, int size, Args &&... args) :
+        value(std::forward<Args>(args)...), p_left(p_left), p_right(p_right),
+        p_parent(p_parent), size(size)
+    {
+    }
+};
+
+/// binary tree shared pool structure (shared by trees that exchanged nodes,
+/// keeping the slabs of deleted ones until the last of them is deleted)
+template <typename T>
+struct btree_pool {
+    pool< btree_node<T> > nodes;     ///< slabs (& free nodes) of deleted trees
+    int                   refs;      ///< number of trees & pools referring
+    btree_pool<T>        *p_forward; ///< pool merged into (NULL: none)
 };
 
-/// binary tree class
+/**
+ * @brief Binary tree class.
+ *
+ * Every node also records the size of it's sub-tree (kept up to date by add,
+ * remove & build along the path they change), so the k-th smallest value &
+ * the number of values below a given one are found in a single descent:
+ * select(), rank() & count_range() are O(depth), i.e. O(log n) if balanced.
+ *
+ * split(), join() & erase_range() relink whole sub-trees along one or two
+ * root-to-leaf paths instead of moving values one by one. Every tree
+ * allocates from (& releases to) a node pool of it's own, so trees split
+ * from one another may be used by different threads at the same time. Their
+ * nodes may still live in each other's slabs though: trees that exchanged
+ * nodes share a btree_pool, which a deleted tree hands it's slabs to, &
+ * which is deleted (with those slabs) along with the last of these trees.
+ * join() merges the other tree's shared pool into this tree's (O(1)),
+ * leaving a forwarding link for any other tree still using it. Shared pools
+ * are only touched by split(), join() & the destructor, under one lock.
+ */
 template <typename T>
 class btree
 {
 public:
 
+    /// in-order (ascending) iterator class
+    class iterator
+    {
+    public:
+
+        typedef std::forward_iterator_tag iterator_category; ///< category
+        typedef T                         value_type;        ///< value type
+        typedef ptrdiff_t                 difference_type;   ///< difference
+        typedef const T                  *pointer;           ///< pointer
+        typedef const T                  &reference;         ///< reference
+
+        /**
+         * @brief Constructor.
+         *
+         * @param[in] p_node: Pointer to node structure (NULL for end).
+         */
+        explicit iterator(btree_node<T> *p_node = NULL) : p_node(p_node) {}
+
+        /**
+         * @brief Get node at iterator's position.
+         *
+         * @retval Pointer to node structure.
+         */
+        btree_node<T> *node() const { return p_node; }
+
+        /// dereference (values are read-only: changing one would break order)
+        const T &operator*() const { return p_node->value; }
+
+        /// member access
+        const T *operator->() const { return &p_node->value; }
+
+        /// pre-increment
+        iterator &operator++()
+        {
+            p_node = successor(p_node);
+
+            return *this;
+        }
+
+        /// post-increment
+        iterator operator++(int)
+        {
+            iterator temp = *this;
+
+            p_node = successor(p_node);
+
+            return temp;
+        }
+
+        /// equality
+        bool operator==(const iterator &other) const
+        {
+            return p_node == other.p_node;
+        }
+
+        /// inequality
+        bool operator!=(const iterator &other) const
+        {
+            return p_node != other.p_node;
+        }
+
+    private:
+
+        btree_node<T> *p_node; ///< pointer to node structure
+    };
+
     /**
      * @brief Constructor.
      */
@@ -30,6 +159,11 @@ public:
         p_root = NULL;
 
         num_nodes = 0;
+
+        p_pool = new btree_pool<T>;
+
+        p_pool->refs      = 1;
+        p_pool->p_forward = NULL;
     }
 
     /**
@@ -38,6 +172,14 @@ public:
     ~btree()
     {
         btree_delete(p_root);
+
+        std::lock_guard<std::mutex> lock(pool_lock());
+
+        // other trees' nodes may still live in this tree's slabs
+
+        pool_resolve(&p_pool)->nodes.merge(node_pool);
+
+        pool_release(p_pool);
     }
 
     /**
@@ -45,18 +187,177 @@ public:
      *
      * @param[in] value: Value.
      */
-    void add(T value)
+    void add(const T &value)
+    {
+        add_node(node_create(value));
+    }
+
+    /**
+     * @brief Add node with associated value to tree (moving value).
+     *
+     * @param[in,out] value: Value.
+     */
+    void add(T &&value)
     {
-        if (p_root == NULL)
+        add_node(node_create(std::move(value)));
+    }
+
+    /**
+     * @brief Add node to tree, constructing it's value in place.
+     *
+     * The node is created first, so that it's position can be found by
+     * comparing against the value in it.
+     *
+     * @param[in] args: Arguments for value's constructor.
+     */
+    template <typename... Args>
+    void emplace(Args &&... args)
+    {
+        add_node(node_create(std::forward<Args>(args)...));
+    }
+
+    /**
+     * @brief Replace tree's contents with perfectly balanced tree of values.
+     *
+     * Values are copied into an array and, unless already sorted, sorted in
+     * parallel (one chunk per hardware thread, then merged pairwise); nodes
+     * are then allocated in sorted order from a single new slab (the old
+     * nodes' slabs are dropped first, so the tree's nodes are contiguous even
+     * when rebuilt), and linked in a single pass (each range's middle value
+     * becomes it's root). Depth is ceil(log2(n + 1)).
+     *
+     * @param[in] begin: Iterator to first value.
+     * @param[in] end:   Iterator past last value.
+     */
+    template <typename Iterator>
+    void build(Iterator begin, Iterator end)
+    {
+        T              *p_values;
+        btree_node<T> **pp_nodes;
+
+        int count = (int)std::distance(begin, end);
+        int ii;
+
+        btree_delete(p_root);
+
+        p_root = NULL;
+
+        node_pool_drop();
+
+        if (count <= 0)
         {
-            p_root = node_create(value);
+            return;
         }
-        else
+
+        p_values = new T[count];
+
+        std::copy(begin, end, p_values);
+
+        if (std::is_sorted(p_values, p_values + count) == false)
         {
-            add(p_root, value);
+            sort_parallel(p_values, count);
         }
 
-        num_nodes++;
+        node_pool.reserve(count);
+
+        pp_nodes = new btree_node<T> *[count];
+
+        for (ii = 0; ii < count; ii++)
+        {
+            pp_nodes[ii] = node_create(std::move(p_values[ii]));
+        }
+
+        delete [] p_values;
+
+        num_nodes = count;
+
+        link_balanced(pp_nodes, count);
+
+        delete [] pp_nodes;
+    }
+
+    /**
+     * @brief Take read-only snapshot of tree in Eytzinger layout (see
+     *        eytzinger.h; tree is walked with Morris traversal, so it must not
+     *        be accessed concurrently).
+     *
+     * @retval Pointer to new snapshot (to be deleted by caller).
+     */
+    eytzinger<T> *freeze()
+    {
+        eytzinger<T> *p_eytzinger;
+
+        btree_node<T> *p_node = p_root;
+        btree_node<T> *p_pred;
+
+        T *p_sorted = new T[(num_nodes > 0) ? num_nodes : 1];
+
+        int num_sorted = 0;
+        int num_steps;
+
+        // in-order (Morris) traversal collects values in sorted order
+
+        while (p_node != NULL)
+        {
+            if (p_node->p_left != NULL)
+            {
+                p_pred = morris_predecessor(p_node, &num_steps);
+
+                if (p_pred->p_right == NULL)
+                {
+                    p_pred->p_right = p_node;
+
+                    p_node = p_node->p_left;
+
+                    continue;
+                }
+
+                p_pred->p_right = NULL;
+            }
+
+            p_sorted[num_sorted++] = p_node->value;
+
+            p_node = p_node->p_right;
+        }
+
+        p_eytzinger = new eytzinger<T>(p_sorted, num_sorted);
+
+        delete [] p_sorted;
+
+        return p_eytzinger;
+    }
+
+    /**
+     * @brief Save tree to image file (Eytzinger layout, see eytzinger.h).
+     *
+     * @param[in] path: File path.
+     *
+     * @retval  true if file written.
+     * @retval false if file could not be written.
+     */
+    bool save(const char *path)
+    {
+        eytzinger<T> *p_eytzinger = freeze();
+
+        bool saved = p_eytzinger->save(path);
+
+        delete p_eytzinger;
+
+        return saved;
+    }
+
+    /**
+     * @brief Map image file written by save(): find & range queries are
+     *        served from the file's pages, without building a tree.
+     *
+     * @param[in] path: File path.
+     *
+     * @retval NULL if file could not be mapped or is not a matching image.
+     * @retval Pointer to new (read-only) snapshot (to be deleted by caller).
+     */
+    static eytzinger<T> *map(const char *path)
+    {
+        return eytzinger<T>::map(path);
     }
 
     /**
@@ -68,323 +369,1308 @@ public:
      * @retval NULL if node with associated value not found.
      * @retval Pointer to node with associated value.
      */
-    btree_node<T> *find(btree_node<T> *p_node, T value)
+    btree_node<T> *find(btree_node<T> *p_node, const T &value)
+    {
+        while ((p_node != NULL) && !(p_node->value == value))
+        {
+            p_node = (value < p_node->value) ? p_node->p_left :
+                                               p_node->p_right;
+        }
+
+        return p_node;
+    }
+
+    /**
+     * @brief Find nodes with associated values for a batch of values.
+     *
+     * Lookups are advanced in lock-step, BTREE_BATCH_SIZE at a time: each
+     * round moves every unfinished lookup one level down & prefetches the
+     * node it moved to, so the cache misses of one round's lookups overlap
+     * instead of each lookup waiting for it's own misses in turn.
+     *
+     * @param[in]  p_values: Pointer to values.
+     * @param[in]  count:    Number of values.
+     * @param[out] pp_nodes: Pointer to found nodes (NULL where not found).
+     */
+    void find_batch(const T *p_values, int count,
+                    btree_node<T> **pp_nodes) const
+    {
+        btree_node<T> *p_node;
+
+        int first;
+        int num_lookups;
+        int num_moved;
+        int ii;
+
+        for (first = 0; first < count; first += BTREE_BATCH_SIZE)
+        {
+            num_lookups = std::min(BTREE_BATCH_SIZE, count - first);
+
+            for (ii = 0; ii < num_lookups; ii++)
+            {
+                pp_nodes[first + ii] = p_root;
+            }
+
+            do
+            {
+                num_moved = 0;
+
+                for (ii = 0; ii < num_lookups; ii++)
+                {
+                    p_node = pp_nodes[first + ii];
+
+                    if ((p_node == NULL) ||
+                        (p_node->value == p_values[first + ii]))
+                    {
+                        continue; // lookup finished
+                    }
+
+                    p_node = (p_values[first + ii] < p_node->value) ?
+                             p_node->p_left : p_node->p_right;
+
+                    if (p_node != NULL)
+                    {
+                        __builtin_prefetch(p_node);
+                    }
+
+                    pp_nodes[first + ii] = p_node;
+
+                    num_moved++;
+                }
+            }
+            while (num_moved > 0);
+        }
+    }
+
+    /**
+     * @brief Get iterator to smallest value.
+     *
+     * @retval Iterator.
+     */
+    iterator begin() const
+    {
+        return iterator((p_root == NULL) ? NULL : leftmost(p_root));
+    }
+
+    /**
+     * @brief Get iterator past largest value.
+     *
+     * @retval Iterator.
+     */
+    iterator end() const
+    {
+        return iterator(NULL);
+    }
+
+    /**
+     * @brief Find first value not less than value (O(log n) if balanced).
+     *
+     * @param[in] value: Value.
+     *
+     * @retval Iterator to first value >= value (end() if none).
+     */
+    iterator lower_bound(const T &value) const
     {
-        if (p_node == NULL)
+        btree_node<T> *p_node  = p_root;
+        btree_node<T> *p_found = NULL;
+
+        while (p_node != NULL)
         {
-            return NULL;
+            if (p_node->value < value)
+            {
+                p_node = p_node->p_right;
+            }
+            else
+            {
+                p_found = p_node;
+
+                p_node = p_node->p_left;
+            }
         }
-        else if (p_node->value == value)
+
+        return iterator(p_found);
+    }
+
+    /**
+     * @brief Find first value greater than value (O(log n) if balanced).
+     *
+     * @param[in] value: Value.
+     *
+     * @retval Iterator to first value > value (end() if none).
+     */
+    iterator upper_bound(const T &value) const
+    {
+        btree_node<T> *p_node  = p_root;
+        btree_node<T> *p_found = NULL;
+
+        while (p_node != NULL)
         {
-            return p_node;
+            if (value < p_node->value)
+            {
+                p_found = p_node;
+
+                p_node = p_node->p_left;
+            }
+            else
+            {
+                p_node = p_node->p_right;
+            }
         }
-        else if (value < p_node->value)
+
+        return iterator(p_found);
+    }
+
+    /**
+     * @brief Find range of values equal to value.
+     *
+     * @param[in] value: Value.
+     *
+     * @retval Iterators to first value equal to value & past last one.
+     */
+    std::pair<iterator, iterator> equal_range(const T &value) const
+    {
+        return std::make_pair(lower_bound(value), upper_bound(value));
+    }
+
+    /**
+     * @brief Visit values in [first, last) in ascending order (O(log n + k)
+     *        if balanced).
+     *
+     * @param[in] first: Smallest value to visit.
+     * @param[in] last:  Value past largest value to visit.
+     * @param[in] visit: Visitor, called with each value (const T &).
+     *
+     * @retval Number of values visited.
+     */
+    template <typename Visitor>
+    int for_each_in_range(const T &first, const T &last, Visitor visit) const
+    {
+        iterator it;
+
+        int count = 0;
+
+        for (it = lower_bound(first); (it != end()) && (*it < last); ++it)
         {
-            return find(p_node->p_left, value);
+            visit(*it);
+
+            count++;
         }
-        else
+
+        return count;
+    }
+
+    /**
+     * @brief Find k-th smallest value (O(log n) if balanced).
+     *
+     * @param[in] k: Rank of value (0 for smallest).
+     *
+     * @retval Iterator to k-th smallest value (end() if k is out of range).
+     */
+    iterator select(int k) const
+    {
+        btree_node<T> *p_node = p_root;
+
+        int size_left;
+
+        while (p_node != NULL)
         {
-            return find(p_node->p_right, value);
+            size_left = subtree_size(p_node->p_left);
+
+            if (k < size_left)
+            {
+                p_node = p_node->p_left;
+            }
+            else if (k == size_left)
+            {
+                break;
+            }
+            else
+            {
+                k -= size_left + 1;
+
+                p_node = p_node->p_right;
+            }
         }
+
+        return iterator(p_node);
     }
 
     /**
-     * @brief Remove node with associated value.
+     * @brief Get number of values less than value (O(log n) if balanced).
      *
      * @param[in] value: Value.
      *
-     * @retval  true if node with associated value removed.
-     * @retval false if node with associated value not removed.
+     * @retval Rank of value (i.e. rank of lower_bound(value)).
+     */
+    int rank(const T &value) const
+    {
+        btree_node<T> *p_node = p_root;
+
+        int count = 0;
+
+        while (p_node != NULL)
+        {
+            if (p_node->value < value)
+            {
+                count += subtree_size(p_node->p_left) + 1;
+
+                p_node = p_node->p_right;
+            }
+            else
+            {
+                p_node = p_node->p_left;
+            }
+        }
+
+        return count;
+    }
+
+    /**
+     * @brief Count values in [first, last) (O(log n) if balanced).
+     *
+     * @param[in] first: Smallest value to count.
+     * @param[in] last:  Value past largest value to count.
+     *
+     * @retval Number of values.
+     */
+    int count_range(const T &first, const T &last) const
+    {
+        if (!(first < last))
+        {
+            return 0;
+        }
+
+        return rank(last) - rank(first);
+    }
+
+    /**
+     * @brief Split tree: values >= key move to new tree (O(depth)).
+     *
+     * The tree is cut along key's search path: path nodes < key are chained
+     * (through their right links) into this tree, the others (through their
+     * left links) into the new one, taking their other sub-trees along.
+     *
+     * @param[in] key: Smallest value to move.
+     *
+     * @retval Pointer to new tree (to be deleted by caller; has it's own node
+     *         pool, so it may be used by another thread than this tree).
+     */
+    btree<T> *split(const T &key)
+    {
+        btree<T> *p_btree;
+
+        {
+            std::lock_guard<std::mutex> lock(pool_lock());
+
+            p_btree = new btree<T>(pool_resolve(&p_pool));
+        }
+
+        split_nodes(p_root, key, &p_root, &p_btree->p_root);
+
+        p_btree->num_nodes = subtree_size(p_btree->p_root);
+
+        num_nodes -= p_btree->num_nodes;
+
+        return p_btree;
+    }
+
+    /**
+     * @brief Append other tree's values, none of which may be smaller than
+     *        this tree's (O(depth) of this tree; depth grows by at most one).
+     *
+     * This tree's largest node is unlinked and becomes the root, with this
+     * tree as left sub-tree & other tree as right sub-tree.
+     *
+     * @param[in,out] other: Other tree (empty afterwards).
+     */
+    void join(btree<T> &other)
+    {
+        if ((&other == this) || (other.p_root == NULL))
+        {
+            return;
+        }
+
+        assert((p_root == NULL) ||
+               !(leftmost(other.p_root)->value <
+                 rightmost(p_root)->value));
+
+        node_pool.merge(other.node_pool);
+
+        pool_merge(other);
+
+        p_root = join_nodes(p_root, other.p_root);
+
+        num_nodes += other.num_nodes;
+
+        other.p_root = NULL;
+
+        other.num_nodes = 0;
+    }
+
+    /**
+     * @brief Remove all values in [first, last): split twice, join outer
+     *        parts, delete middle part (O(depth + k)).
+     *
+     * @param[in] first: Smallest value to remove.
+     * @param[in] last:  Value past largest value to remove.
+     *
+     * @retval Number of values removed.
+     */
+    int erase_range(const T &first, const T &last)
+    {
+        btree_node<T> *p_middle;
+        btree_node<T> *p_right;
+
+        int count;
+
+        if (!(first < last))
+        {
+            return 0;
+        }
+
+        split_nodes(p_root,   first, &p_root,   &p_middle);
+        split_nodes(p_middle, last,  &p_middle, &p_right);
+
+        p_root = join_nodes(p_root, p_right);
+
+        count = subtree_size(p_middle);
+
+        btree_delete(p_middle);
+
+        return count;
+    }
+
+    /**
+     * @brief Remove node with associated value.
+     *
+     * @param[in] value: Value.
+     *
+     * @retval  true if node with associated value removed.
+     * @retval false if node with associated value not removed.
+     */
+    bool remove(const T &value)
+    {
+        bool node_removed = false;
+
+        btree_node<T> *p_node_current;
+        btree_node<T> *p_node_parent;
+
+        p_node_current = find_node_and_parent(&p_node_parent, value);
+
+        if (p_node_current != NULL)
+        {
+            /**
+             * Case 1: Current node has no right child.
+             *
+             * - Current node's left child replaces it.
+             */
+            if (p_node_current->p_right == NULL)
+            {
+                if (p_node_parent == NULL)
+                {
+                    p_root = p_node_current->p_left;
+                }
+                else
+                {
+                    if (p_node_parent->p_left == p_node_current)
+                    {
+                        // current node is it's parent's left child
+
+                        p_node_parent->p_left = p_node_current->p_left;
+                    }
+                    else
+                    {
+                        // current node is it's parent's right child
+
+                        p_node_parent->p_right = p_node_current->p_left;
+                    }
+                }
+
+                parent_set(p_node_current->p_left, p_node_parent);
+
+                size_decrement(p_node_parent);
+
+                node_delete(p_node_current);
+
+                node_removed = true;
+            }
+
+            /**
+             * Case 2: Current node's right child has no left child.
+             *
+             * - Current node's right child replaces it.
+             */
+            else if (p_node_current->p_right->p_left == NULL)
+            {
+                p_node_current->p_right->p_left = p_node_current->p_left;
+
+                parent_set(p_node_current->p_left, p_node_current->p_right);
+
+                if (p_node_parent == NULL)
+                {
+                    p_root = p_node_current->p_right;
+                }
+                else
+                {
+                    if (p_node_parent->p_left == p_node_current)
+                    {
+                        // current node is it's parent's left child
+
+                        p_node_parent->p_left = p_node_current->p_right;
+                    }
+                    else
+                    {
+                        // current node is it's parent's right child
+
+                        p_node_parent->p_right = p_node_current->p_right;
+                    }
+                }
+
+                parent_set(p_node_current->p_right, p_node_parent);
+
+                p_node_current->p_right->size = p_node_current->size;
+
+                size_decrement(p_node_current->p_right);
+
+                node_delete(p_node_current);
+
+                node_removed = true;
+            }
+
+            /**
+             * Case 3: Current node's right child has a left child.
+             *
+             * - Current node's right child's left-most child replaces it.
+             */
+            else
+            {
+                // find right child's left-most child & it's parent
+
+                btree_node<T> *p_node_leftmost;
+                btree_node<T> *p_node_leftmost_parent;
+
+                p_node_leftmost        = p_node_current->p_right->p_left;
+                p_node_leftmost_parent = p_node_current->p_right;
+
+                while (p_node_leftmost->p_left != NULL)
+                {
+                    p_node_leftmost_parent = p_node_leftmost;
+
+                    p_node_leftmost = p_node_leftmost->p_left;
+                }
+
+                // left-most's right subtree becomes it's parent's left subtree
+
+                p_node_leftmost_parent->p_left = p_node_leftmost->p_right;
+
+                parent_set(p_node_leftmost->p_right, p_node_leftmost_parent);
+
+                // re-assign current node's left & right children
+
+                p_node_leftmost->p_left  = p_node_current->p_left;
+                p_node_leftmost->p_right = p_node_current->p_right;
+
+                parent_set(p_node_current->p_left,  p_node_leftmost);
+                parent_set(p_node_current->p_right, p_node_leftmost);
+
+                if (p_node_parent == NULL)
+                {
+                    p_root = p_node_leftmost;
+                }
+                else
+                {
+                    if (p_node_parent->p_left == p_node_current)
+                    {
+                        // current node is it's parent's left child
+
+                        p_node_parent->p_left = p_node_leftmost;
+                    }
+                    else
+                    {
+                        // current node is it's parent's right child
+
+                        p_node_parent->p_right = p_node_leftmost;
+                    }
+                }
+
+                parent_set(p_node_leftmost, p_node_parent);
+
+                // left-most's old parent is now below it
+
+                p_node_leftmost->size = p_node_current->size;
+
+                size_decrement(p_node_leftmost_parent);
+
+                node_delete(p_node_current);
+
+                node_removed = true;
+            }
+        }
+
+        return node_removed;
+    }
+
+    /**
+     * @brief Get depth of sub-tree (Morris traversal: no recursion, no extra
+     *        memory; sub-tree is temporarily threaded, so it must not be
+     *        accessed concurrently).
+     *
+     * Each node is reached once by descending & once more by following the
+     * thread back from it's in-order predecessor; in the latter case, the
+     * length of the predecessor walk tells how far back up the thread went.
+     *
+     * @param[in] p_node: Pointer to sub-tree's root node.
+     *
+     * @retval Depth of sub-tree.
+     */
+    int depth(btree_node<T> *p_node)
+    {
+        btree_node<T> *p_pred;
+
+        int depth_current = 1;
+        int depth_max     = 0;
+        int num_steps;
+
+        while (p_node != NULL)
+        {
+            if (p_node->p_left == NULL)
+            {
+                // deepest nodes have no left child
+
+                if (depth_current > depth_max)
+                {
+                    depth_max = depth_current;
+                }
+
+                p_node = p_node->p_right;
+
+                depth_current++;
+
+                continue;
+            }
+
+            p_pred = morris_predecessor(p_node, &num_steps);
+
+            if (p_pred->p_right == NULL)
+            {
+                // first visit: thread predecessor back to node, go left
+
+                p_pred->p_right = p_node;
+
+                p_node = p_node->p_left;
+
+                depth_current++;
+            }
+            else
+            {
+                // second visit (came back up thread): unthread, go right
+
+                p_pred->p_right = NULL;
+
+                depth_current -= num_steps + 1;
+
+                p_node = p_node->p_right;
+
+                depth_current++;
+            }
+        }
+
+        return depth_max;
+    }
+
+    /**
+     * @brief Verify tree by traversing it in-order and checking that no element
+     *        is greater than it's predecessor, and that every node's parent
+     *        links & sub-tree size are correct (Morris traversal: no
+     *        recursion, no extra memory; sub-tree is temporarily threaded, so
+     *        it must not be accessed concurrently).
+     *
+     * A visited node's right link may be a thread back to an ancestor; only a
+     * real child links back to it, so a thread counts as an empty sub-tree.
+     *
+     * @param[in] p_node:     Pointer to sub-tree's root node.
+     * @param[in] value_prev: Previous value.
+     *
+     * @retval  true if binary tree is correct
+     * @retval false if binary tree is incorrect
+     */
+    bool verify(btree_node<T> *p_node, T value_prev)
+    {
+        btree_node<T> *p_pred;
+        btree_node<T> *p_right;
+
+        bool retval = true;
+
+        int num_steps;
+
+        // traversal always runs to completion, so that all threads are removed
+
+        while (p_node != NULL)
+        {
+            if (p_node->p_left != NULL)
+            {
+                p_pred = morris_predecessor(p_node, &num_steps);
+
+                if (p_pred->p_right == NULL)
+                {
+                    p_pred->p_right = p_node;
+
+                    p_node = p_node->p_left;
+
+                    continue;
+                }
+
+                p_pred->p_right = NULL;
+            }
+
+            // visit node
+
+            if (p_node->value < value_prev)
+            {
+                retval = false;
+            }
+
+            value_prev = p_node->value;
+
+            p_right = p_node->p_right;
+
+            if ((p_right != NULL) && (p_right->p_parent != p_node))
+            {
+                p_right = NULL; // thread
+            }
+
+            if (((p_node->p_left != NULL) &&
+                 (p_node->p_left->p_parent != p_node)) ||
+                (p_node->size != subtree_size(p_node->p_left) +
+                                 subtree_size(p_right) + 1))
+            {
+                retval = false;
+            }
+
+            p_node = p_node->p_right;
+        }
+
+        return retval;
+    }
+
+    btree_node<T> *p_root; ///< pointer to root node
+
+private:
+
+    /**
+     * @brief Constructor (empty tree sharing shared pool, for split();
+     *        caller holds pool_lock()).
+     *
+     * @param[in,out] p_pool_shared: Pointer to shared pool.
+     */
+    explicit btree(btree_pool<T> *p_pool_shared)
+    {
+        p_root = NULL;
+
+        num_nodes = 0;
+
+        p_pool = p_pool_shared;
+
+        p_pool->refs++;
+    }
+
+    /**
+     * @brief Link new node into tree.
+     *
+     * @param[in,out] p_node_new: Pointer to new node structure.
+     */
+    void add_node(btree_node<T> *p_node_new)
+    {
+        btree_node<T> **pp_link = &p_root;
+        btree_node<T>  *p_node  = NULL;
+
+        // follow links down to empty one
+
+        while (*pp_link != NULL)
+        {
+            p_node = *pp_link;
+
+            p_node->size++; // new node ends up in this node's sub-tree
+
+            pp_link = (p_node_new->value < p_node->value) ? &p_node->p_left :
+                                                            &p_node->p_right;
+        }
+
+        *pp_link = p_node_new;
+
+        p_node_new->p_parent = p_node;
+
+        num_nodes++;
+    }
+
+    /**
+     * @brief Find node's in-order predecessor in it's left sub-tree, stopping
+     *        at a thread back to node (Morris traversal).
+     *
+     * @param[in]  p_node:      Pointer to node (with left child).
+     * @param[out] p_num_steps: Pointer to number of links followed.
+     *
+     * @retval Pointer to predecessor node.
+     */
+    static btree_node<T> *morris_predecessor(btree_node<T> *p_node,
+                                             int *p_num_steps)
+    {
+        btree_node<T> *p_pred = p_node->p_left;
+
+        *p_num_steps = 1;
+
+        while ((p_pred->p_right != NULL) && (p_pred->p_right != p_node))
+        {
+            p_pred = p_pred->p_right;
+
+            (*p_num_steps)++;
+        }
+
+        return p_pred;
+    }
+
+    /**
+     * @brief Sort values in parallel: sort equal chunks in separate threads,
+     *        then merge neighbouring chunks pairwise (also in parallel).
+     *
+     * @param[in,out] p_values: Pointer to values.
+     * @param[in]     count:    Number of values.
+     */
+    static void sort_parallel(T *p_values, int count)
+    {
+        std::thread *p_threads;
+
+        int *p_bounds;
+
+        int num_chunks = (int)std::thread::hardware_concurrency();
+        int width;
+        int ii;
+
+        if (num_chunks > count / BTREE_SORT_CHUNK_MIN)
+        {
+            num_chunks = count / BTREE_SORT_CHUNK_MIN;
+        }
+
+        if (num_chunks <= 1)
+        {
+            std::sort(p_values, p_values + count);
+
+            return;
+        }
+
+        p_threads = new std::thread[num_chunks];
+
+        p_bounds = new int[num_chunks + 1];
+
+        for (ii = 0; ii <= num_chunks; ii++)
+        {
+            p_bounds[ii] = (int)(((long long)count * ii) / num_chunks);
+        }
+
+        for (ii = 0; ii < num_chunks; ii++)
+        {
+            T *p_first = p_values + p_bounds[ii];
+            T *p_last  = p_values + p_bounds[ii + 1];
+
+            p_threads[ii] = std::thread(sort_range, p_first, p_last);
+        }
+
+        for (ii = 0; ii < num_chunks; ii++)
+        {
+            p_threads[ii].join();
+        }
+
+        for (width = 1; width < num_chunks; width *= 2)
+        {
+            for (ii = 0; ii + width < num_chunks; ii += 2 * width)
+            {
+                T *p_first  = p_values + p_bounds[ii];
+                T *p_middle = p_values + p_bounds[ii + width];
+                T *p_last   = p_values + p_bounds[std::min(ii + 2 * width,
+                                                           num_chunks)];
+
+                p_threads[ii] = std::thread(merge_ranges, p_first, p_middle,
+                                            p_last);
+            }
+
+            for (ii = 0; ii + width < num_chunks; ii += 2 * width)
+            {
+                p_threads[ii].join();
+            }
+        }
+
+        delete [] p_bounds;
+
+        delete [] p_threads;
+    }
+
+    /**
+     * @brief Sort range of values (sort thread).
+     *
+     * @param[in,out] p_first: Pointer to first value.
+     * @param[in,out] p_last:  Pointer past last value.
+     */
+    static void sort_range(T *p_first, T *p_last)
+    {
+        std::sort(p_first, p_last);
+    }
+
+    /**
+     * @brief Merge two neighbouring sorted ranges of values (merge thread).
+     *
+     * @param[in,out] p_first:  Pointer to first value of first range.
+     * @param[in,out] p_middle: Pointer to first value of second range.
+     * @param[in,out] p_last:   Pointer past last value of second range.
+     */
+    static void merge_ranges(T *p_first, T *p_middle, T *p_last)
+    {
+        std::inplace_merge(p_first, p_middle, p_last);
+    }
+
+    /**
+     * @brief Link sorted nodes into perfectly balanced tree (iteratively,
+     *        with a stack of ranges still to be linked).
+     *
+     * @param[in,out] pp_nodes: Pointer to nodes (sorted).
+     * @param[in]     count:    Number of nodes.
+     */
+    void link_balanced(btree_node<T> **pp_nodes, int count)
+    {
+        struct range {
+            int             first;    ///< index of first node
+            int             last;     ///< index past last node
+            btree_node<T> **pp_link;  ///< link to range's root node
+            btree_node<T>  *p_parent; ///< range's root node's parent
+        } ranges[BTREE_BUILD_STACK];
+
+        int num_ranges = 0;
+        int middle;
+
+        ranges[num_ranges++] = { 0, count, &p_root, NULL };
+
+        while (num_ranges > 0)
+        {
+            range current = ranges[--num_ranges];
+
+            if (current.first >= current.last)
+            {
+                continue; // empty range: link already NULL
+            }
+
+            middle = current.first + (current.last - current.first) / 2;
+
+            *current.pp_link = pp_nodes[middle];
+
+            pp_nodes[middle]->p_parent = current.p_parent;
+            pp_nodes[middle]->size     = current.last - current.first;
+
+            assert(num_ranges + 2 <= BTREE_BUILD_STACK);
+
+            ranges[num_ranges++] = { current.first, middle,
+                                     &pp_nodes[middle]->p_left,
+                                     pp_nodes[middle] };
+            ranges[num_ranges++] = { middle + 1, current.last,
+                                     &pp_nodes[middle]->p_right,
+                                     pp_nodes[middle] };
+        }
+    }
+
+    /**
+     * @brief Find node with associated value and it's parent node.
+     *
+     * @param[in,out] pp_node_parent: Pointer to pointer to parent node of node
+     *                                with associated value.
+     * @param[in]     value:          Value.
+     *
+     * @retval NULL if node with associated value not found.
+     * @retval Pointer to node with associated value.
+     */
+    btree_node<T> *find_node_and_parent(btree_node<T> **pp_node_parent,
+                                        const T &value)
+    {
+        btree_node<T> *p_node_current;
+
+        p_node_current = p_root;
+
+        *pp_node_parent = NULL;
+
+        while (p_node_current != NULL)
+        {
+            if (value < p_node_current->value)
+            {
+                *pp_node_parent = p_node_current;
+
+                p_node_current = p_node_current->p_left;
+            }
+            else if (value == p_node_current->value)
+            {
+                break;
+            }
+            else
+            {
+                *pp_node_parent = p_node_current;
+
+                p_node_current = p_node_current->p_right;
+            }
+        }
+
+        return p_node_current;
+    }
+
+    /**
+     * @brief Get sub-tree's left-most (smallest) node.
+     *
+     * @param[in] p_node: Pointer to sub-tree's root node.
+     *
+     * @retval Pointer to left-most node.
+     */
+    static btree_node<T> *leftmost(btree_node<T> *p_node)
+    {
+        while (p_node->p_left != NULL)
+        {
+            p_node = p_node->p_left;
+        }
+
+        return p_node;
+    }
+
+    /**
+     * @brief Get sub-tree's right-most (largest) node.
+     *
+     * @param[in] p_node: Pointer to sub-tree's root node.
+     *
+     * @retval Pointer to right-most node.
+     */
+    static btree_node<T> *rightmost(btree_node<T> *p_node)
+    {
+        while (p_node->p_right != NULL)
+        {
+            p_node = p_node->p_right;
+        }
+
+        return p_node;
+    }
+
+    /**
+     * @brief Split sub-tree into values < key & values >= key, along key's
+     *        search path (sizes on both new paths are recomputed bottom-up).
+     *
+     * @param[in,out] p_node:   Pointer to sub-tree's root node (may be NULL).
+     * @param[in]     key:      Key.
+     * @param[out]    pp_left:  Pointer to root of values < key.
+     * @param[out]    pp_right: Pointer to root of values >= key.
      */
-    bool remove(T value)
+    static void split_nodes(btree_node<T> *p_node, const T &key,
+                            btree_node<T> **pp_left, btree_node<T> **pp_right)
     {
-        bool node_removed = false;
-
-        btree_node<T> *p_node_current;
-        btree_node<T> *p_node_parent;
+        btree_node<T> **pp_left_link  = pp_left;
+        btree_node<T> **pp_right_link = pp_right;
+        btree_node<T>  *p_left_last   = NULL;
+        btree_node<T>  *p_right_last  = NULL;
+        btree_node<T>  *p_next;
 
-        p_node_current = find_node_and_parent(&p_node_parent, value);
-
-        if (p_node_current != NULL)
+        while (p_node != NULL)
         {
-            /**
-             * Case 1: Current node has no right child.
-             *
-             * - Current node's left child replaces it.
-             */
-            if (p_node_current->p_right == NULL)
+            if (p_node->value < key)
             {
-                if (p_node_parent == NULL)
-                {
-                    p_root = p_node_current->p_left;
-                }
-                else
-                {
-                    if (p_node_current->value < p_node_parent->value)
-                    {
-                        // current node is it's parent's left child
+                // node & it's left sub-tree go left, continue in right one
 
-                        p_node_parent->p_left = p_node_current->p_left;
-                    }
-                    else
-                    {
-                        // current node is it's parent's right child
+                p_next = p_node->p_right;
 
-                        p_node_parent->p_right = p_node_current->p_left;
-                    }
-                }
+                *pp_left_link = p_node;
 
-                node_delete(p_node_current);
+                p_node->p_parent = p_left_last;
 
-                node_removed = true;
-            }
+                p_left_last = p_node;
 
-            /**
-             * Case 2: Current node's right child has no left child.
-             *
-             * - Current node's right child replaces it.
-             */
-            else if (p_node_current->p_right->p_left == NULL)
+                pp_left_link = &p_node->p_right;
+            }
+            else
             {
-                p_node_current->p_right->p_left = p_node_current->p_left;
+                // node & it's right sub-tree go right, continue in left one
 
-                if (p_node_parent == NULL)
-                {
-                    p_root = p_node_current->p_right;
-                }
-                else
-                {
-                    if (p_node_current->value < p_node_parent->value)
-                    {
-                        // current node is it's parent's left child
+                p_next = p_node->p_left;
 
-                        p_node_parent->p_left = p_node_current->p_right;
-                    }
-                    else
-                    {
-                        // current node is it's parent's right child
+                *pp_right_link = p_node;
 
-                        p_node_parent->p_right = p_node_current->p_right;
-                    }
-                }
+                p_node->p_parent = p_right_last;
 
-                node_delete(p_node_current);
+                p_right_last = p_node;
 
-                node_removed = true;
+                pp_right_link = &p_node->p_left;
             }
 
-            /**
-             * Case 3: Current node's right child has a left child.
-             *
-             * - Current node's right child's left-most child replaces it.
-             */
-            else
-            {
-                // find right child's left-most child & it's parent
-
-                btree_node<T> *p_node_leftmost;
-                btree_node<T> *p_node_leftmost_parent;
+            p_node = p_next;
+        }
 
-                p_node_leftmost        = p_node_current->p_right->p_left;
-                p_node_leftmost_parent = p_node_current->p_right;
+        *pp_left_link  = NULL;
+        *pp_right_link = NULL;
 
-                while (p_node_leftmost->p_left != NULL)
-                {
-                    p_node_leftmost_parent = p_node_leftmost;
+        size_update_path(p_left_last);
+        size_update_path(p_right_last);
+    }
 
-                    p_node_leftmost = p_node_leftmost->p_left;
-                }
+    /**
+     * @brief Join two sub-trees (no value in left one greater than any in
+     *        right one): left one's right-most node becomes root.
+     *
+     * @param[in,out] p_left:  Pointer to left sub-tree's root (may be NULL).
+     * @param[in,out] p_right: Pointer to right sub-tree's root (may be NULL).
+     *
+     * @retval Pointer to joined sub-tree's root.
+     */
+    static btree_node<T> *join_nodes(btree_node<T> *p_left,
+                                     btree_node<T> *p_right)
+    {
+        btree_node<T> *p_max;
 
-                // left-most's right subtree becomes it's parent's left subtree
+        if (p_left == NULL)
+        {
+            return p_right;
+        }
 
-                p_node_leftmost_parent->p_left = p_node_leftmost->p_right;
+        if (p_right == NULL)
+        {
+            return p_left;
+        }
 
-                // re-assign current node's left & right children
+        p_max = rightmost(p_left);
 
-                p_node_leftmost->p_left  = p_node_current->p_left;
-                p_node_leftmost->p_right = p_node_current->p_right;
+        if (p_max != p_left)
+        {
+            // right-most node's left sub-tree takes it's place
 
-                if (p_node_parent == NULL)
-                {
-                    p_root = p_node_leftmost;
-                }
-                else
-                {
-                    if (p_node_current->value < p_node_parent->value)
-                    {
-                        // current node is it's parent's left child
+            p_max->p_parent->p_right = p_max->p_left;
 
-                        p_node_parent->p_left = p_node_leftmost;
-                    }
-                    else
-                    {
-                        // current node is it's parent's right child
+            parent_set(p_max->p_left, p_max->p_parent);
 
-                        p_node_parent->p_right = p_node_leftmost;
-                    }
-                }
+            size_decrement(p_max->p_parent);
 
-                node_delete(p_node_current);
+            p_max->p_left = p_left;
 
-                node_removed = true;
-            }
+            p_left->p_parent = p_max;
         }
 
-        return node_removed;
+        p_max->p_right = p_right;
+
+        p_right->p_parent = p_max;
+
+        p_max->p_parent = NULL;
+
+        p_max->size = subtree_size(p_max->p_left) + p_right->size + 1;
+
+        return p_max;
     }
 
     /**
-     * @brief Get depth of sub-tree recursively.
-     *
-     * @param[in] p_node: Pointer to sub-tree's root node.
+     * @brief Recompute sub-tree sizes from node up to root (after node's
+     *        children changed).
      *
-     * @retval Depth of sub-tree.
+     * @param[in,out] p_node: Pointer to node structure (may be NULL).
      */
-    int depth(btree_node<T> *p_node)
+    static void size_update_path(btree_node<T> *p_node)
     {
-        if (p_node == NULL)
+        while (p_node != NULL)
         {
-            return 0;
+            p_node->size = subtree_size(p_node->p_left) +
+                           subtree_size(p_node->p_right) + 1;
+
+            p_node = p_node->p_parent;
         }
-        else
+    }
+
+    /**
+     * @brief Get node's in-order successor: right sub-tree's left-most node,
+     *        else first ancestor whose left sub-tree node is in.
+     *
+     * @param[in] p_node: Pointer to node structure.
+     *
+     * @retval NULL if node is last.
+     * @retval Pointer to successor node.
+     */
+    static btree_node<T> *successor(btree_node<T> *p_node)
+    {
+        if (p_node->p_right != NULL)
         {
-            int depth_left  = depth(p_node->p_left);
-            int depth_right = depth(p_node->p_right);
+            return leftmost(p_node->p_right);
+        }
 
-            return ((depth_left > depth_right) ? depth_left : depth_right) + 1;
+        while ((p_node->p_parent != NULL) &&
+               (p_node->p_parent->p_right == p_node))
+        {
+            p_node = p_node->p_parent;
         }
+
+        return p_node->p_parent;
     }
 
     /**
-     * @brief Verify tree by traversing it in-order and checking that no element
-     *        is greater than it's predecessor.
+     * @brief Get size of sub-tree.
      *
-     * @param[in] p_node:     Pointer to sub-tree's root node.
-     * @param[in] value_prev: Previous value.
+     * @param[in] p_node: Pointer to sub-tree's root node (may be NULL).
      *
-     * @retval  true if binary tree is correct
-     * @retval false if binary tree is incorrect
+     * @retval Number of nodes in sub-tree (0 if empty).
      */
-    bool verify(btree_node<T> *p_node, T value_prev)
+    static int subtree_size(const btree_node<T> *p_node)
     {
-        bool retval = true;
+        return (p_node == NULL) ? 0 : p_node->size;
+    }
 
-        if (p_node != NULL)
+    /**
+     * @brief Decrement sub-tree sizes from node up to root (after a node
+     *        below it was removed).
+     *
+     * @param[in,out] p_node: Pointer to node structure (may be NULL).
+     */
+    static void size_decrement(btree_node<T> *p_node)
+    {
+        while (p_node != NULL)
         {
-            retval = verify(p_node->p_left, value_prev);
-
-            if (retval == true)
-            {
-                if (p_node->value < value_prev)
-                {
-                    retval = false;
-                }
-                else
-                {
-                    value_prev = p_node->value;
+            p_node->size--;
 
-                    retval = verify(p_node->p_right, value_prev);
-                }
-            }
+            p_node = p_node->p_parent;
         }
+    }
 
-        return retval;
+    /**
+     * @brief Set node's parent (if there is a node).
+     *
+     * @param[in,out] p_node:   Pointer to node structure (may be NULL).
+     * @param[in]     p_parent: Pointer to parent node structure.
+     */
+    static void parent_set(btree_node<T> *p_node, btree_node<T> *p_parent)
+    {
+        if (p_node != NULL)
+        {
+            p_node->p_parent = p_parent;
+        }
     }
 
-    btree_node<T> *p_root; ///< pointer to root node
+    /**
+     * @brief Get lock guarding all shared pools (of trees of this type).
+     *
+     * @retval Reference to lock.
+     */
+    static std::mutex &pool_lock()
+    {
+        static std::mutex lock;
 
-private:
+        return lock;
+    }
 
     /**
-     * @brief Recursive function to add node with associated value to sub-tree.
-     *
-     * @param[in,out] p_node: Pointer to sub-tree's root node.
-     * @param[in]     value:  Value.
+     * @brief Drop (empty) tree's node pool: free it's slabs, unless other
+     *        trees may still hold nodes in them, in which case they are handed
+     *        to the shared pool like on deletion.
      */
-    void add(btree_node<T> *p_node, T value)
+    void node_pool_drop()
     {
-        if (value < p_node->value)
+        pool< btree_node<T> > dropped;
+
+        std::lock_guard<std::mutex> lock(pool_lock());
+
+        btree_pool<T> *p_pool_shared = pool_resolve(&p_pool);
+
+        if (p_pool_shared->refs > 1)
         {
-            if (p_node->p_left == NULL)
-            {
-                p_node->p_left = node_create(value);
-            }
-            else
-            {
-                add(p_node->p_left, value);
-            }
+            p_pool_shared->nodes.merge(node_pool);
         }
         else
         {
-            if (p_node->p_right == NULL)
-            {
-                p_node->p_right = node_create(value);
-            }
-            else
-            {
-                add(p_node->p_right, value);
-            }
+            // no other tree (or shared pool) refers to it: all nodes are free
+
+            dropped.merge(node_pool);
+            dropped.merge(p_pool_shared->nodes);
         }
     }
 
     /**
-     * @brief Find node with associated value and it's parent node.
+     * @brief Follow shared pool's forwarding links to the pool it was merged
+     *        into, moving the reference there (caller holds pool_lock()).
      *
-     * @param[in,out] pp_node_parent: Pointer to pointer to parent node of node
-     *                                with associated value.
-     * @param[in]     value:          Value.
+     * @param[in,out] pp_pool: Pointer to pointer to shared pool.
      *
-     * @retval NULL if node with associated value not found.
-     * @retval Pointer to node with associated value.
+     * @retval Pointer to (unmerged) shared pool.
      */
-    btree_node<T> *find_node_and_parent(btree_node<T> **pp_node_parent, T value)
+    static btree_pool<T> *pool_resolve(btree_pool<T> **pp_pool)
     {
-        btree_node<T> *p_node_current;
+        btree_pool<T> *p_forward;
 
-        p_node_current = p_root;
+        while ((*pp_pool)->p_forward != NULL)
+        {
+            p_forward = (*pp_pool)->p_forward;
 
-        *pp_node_parent = NULL;
+            p_forward->refs++;
 
-        while (p_node_current != NULL)
-        {
-            if (value < p_node_current->value)
-            {
-                *pp_node_parent = p_node_current;
+            pool_release(*pp_pool);
 
-                p_node_current = p_node_current->p_left;
-            }
-            else if (value == p_node_current->value)
-            {
-                break;
-            }
-            else
-            {
-                *pp_node_parent = p_node_current;
+            *pp_pool = p_forward;
+        }
 
-                p_node_current = p_node_current->p_right;
-            }
+        return *pp_pool;
+    }
+
+    /**
+     * @brief Merge other tree's shared pool into this tree's (unless they are
+     *        the same), so that slabs of other tree's nodes outlive this tree.
+     *
+     * @param[in,out] other: Other tree.
+     */
+    void pool_merge(btree<T> &other)
+    {
+        std::lock_guard<std::mutex> lock(pool_lock());
+
+        btree_pool<T> *p_pool_this  = pool_resolve(&p_pool);
+        btree_pool<T> *p_pool_other = pool_resolve(&other.p_pool);
+
+        if (p_pool_other == p_pool_this)
+        {
+            return;
         }
 
-        return p_node_current;
+        p_pool_this->nodes.merge(p_pool_other->nodes);
+
+        p_pool_other->p_forward = p_pool_this;
+
+        p_pool_this->refs++;
     }
 
     /**
-     * @brief Create node with associated value.
+     * @brief Drop reference to shared pool, deleting it (& dropping it's
+     *        forwarding link) if it was the last one (caller holds
+     *        pool_lock()).
      *
-     * @param[in] value: Value.
+     * @param[in,out] p_pool_release: Pointer to shared pool (may be NULL).
+     */
+    static void pool_release(btree_pool<T> *p_pool_release)
+    {
+        btree_pool<T> *p_forward;
+
+        while ((p_pool_release != NULL) && (--p_pool_release->refs == 0))
+        {
+            p_forward = p_pool_release->p_forward;
+
+            delete p_pool_release;
+
+            p_pool_release = p_forward;
+        }
+    }
+
+    /**
+     * @brief Create node, constructing it's value in place.
+     *
+     * @param[in] args: Arguments for value's constructor.
      *
      * @retval Pointer to new node structure.
      */
-    btree_node<T> *node_create(T value)
+    template <typename... Args>
+    btree_node<T> *node_create(Args &&... args)
     {
         btree_node<T> *p_node = NULL;
 
-        p_node = new btree_node<T>;
-
-        p_node->value = value;
-
-        p_node->p_left  = NULL;
-        p_node->p_right = NULL;
+        p_node = new (node_pool.alloc())
+                 btree_node<T>(NULL, NULL, NULL, 1,
+                               std::forward<Args>(args)...);
 
         return p_node;
     }
@@ -396,31 +1682,56 @@ private:
      */
     void node_delete(btree_node<T> *p_node)
     {
-        delete p_node;
+        p_node->~btree_node<T>();
+
+        node_pool.release(p_node);
 
         num_nodes--;
     }
 
     /**
-     * @brief Recursively delete binary tree using post-order traversal.
+     * @brief Delete binary tree without recursion: rotate left children up
+     *        until current node has none, then delete it & move right.
      *
      * @param[in,out] p_node: Pointer to node structure (current sub-tree's
      *                        root node).
      */
     void btree_delete(btree_node<T> *p_node)
     {
-        if (p_node != NULL)
+        btree_node<T> *p_next;
+
+        while (p_node != NULL)
         {
-            btree_delete(p_node->p_left);
-            btree_delete(p_node->p_right);
+            if (p_node->p_left != NULL)
+            {
+                // rotate right: left child becomes sub-tree's root
+
+                p_next = p_node->p_left;
+
+                p_node->p_left = p_next->p_right;
+
+                p_next->p_right = p_node;
+            }
+            else
+            {
+                p_next = p_node->p_right;
 
-            delete p_node;
+                node_delete(p_node);
+            }
 
-            num_nodes--;
+            p_node = p_next;
         }
     }
 
     int num_nodes; ///< number of nodes in tree
+
+    pool< btree_node<T> > node_pool; ///< node pool
+
+    btree_pool<T> *p_pool; ///< pointer to shared pool
 };
 
+// snapshot class (uses btree, so only included once btree is complete)
+
+#include "eytzinger.h"
+
 #endif // #ifndef _BTREE_H_
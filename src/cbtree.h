@@ -0,0 +1,986 @@
+/**
+ * @file  cbtree.h
+ *
+ * @brief Concurrent ordered set class (B+tree, optimistic lock coupling).
+ */
+
+#ifndef _CBTREE_H_
+
+#define _CBTREE_H_
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <atomic>
+#include <new>
+#include <thread>
+#include <type_traits>
+
+#define CBTREE_CACHE_LINE_SIZE 64 ///< cache line size in bytes
+
+#ifndef CBTREE_NODE_SIZE
+#define CBTREE_NODE_SIZE 256 ///< node size in bytes (multiple of cache line)
+#endif
+
+/// concurrent B+tree node structure (common part of leaves & inner nodes)
+template <typename T>
+struct cbtree_node {
+    std::atomic<uint64_t> version;  ///< version (odd while write-locked)
+    std::atomic<int>      num_keys; ///< number of keys in node
+    bool                  is_leaf;  ///< leaf? (fixed when node is created)
+};
+
+/// concurrent B+tree leaf node structure
+template <typename T>
+struct cbtree_leaf : cbtree_node<T> {
+    /// maximum number of keys per leaf
+    static const int capacity =
+        ((CBTREE_NODE_SIZE - 16) / (int)sizeof(std::atomic<T>) > 3) ?
+        ((CBTREE_NODE_SIZE - 16) / (int)sizeof(std::atomic<T>)) : 3;
+
+    std::atomic<T> keys[capacity]; ///< keys (sorted, unique)
+};
+
+/// concurrent B+tree inner node structure
+template <typename T>
+struct cbtree_inner : cbtree_node<T> {
+    /// maximum number of keys per inner node (one less than children)
+    static const int capacity =
+        ((CBTREE_NODE_SIZE - 16) /
+         (int)(sizeof(std::atomic<T>) + sizeof(void *)) > 3) ?
+        ((CBTREE_NODE_SIZE - 16) /
+         (int)(sizeof(std::atomic<T>) + sizeof(void *))) : 3;
+
+    std::atomic<T>                 keys[capacity];           ///< separators
+    std::atomic<cbtree_node<T> *> p_children[capacity + 1]; ///< child nodes
+};
+
+/**
+ * @brief Concurrent ordered set class (B+tree, optimistic lock coupling).
+ *
+ * Same node layout as bptree (keys stored contiguously, only leaves hold
+ * keys, separator k[i] sends keys < k[i] left & keys >= k[i] right), but keys
+ * are unique and every node carries a version counter that doubles as a
+ * write lock (odd: locked; +1 on lock & on unlock):
+ *
+ * - readers take no locks: they note each node's version before reading it,
+ *   read it, and check that the version is unchanged before trusting what
+ *   they read (and, one level down, that the parent's is still unchanged,
+ *   so the child they moved to still covers their key); on a mismatch they
+ *   restart from the root;
+ * - writers descend the same way and lock only the nodes they modify, by
+ *   turning a noted version into a lock with a compare-and-swap (which fails,
+ *   causing a restart, if the node changed in the meantime): the leaf for
+ *   add / remove, plus it's parent when a full node is split. Full nodes are
+ *   split on the way down, so a split never has to propagate upwards.
+ *
+ * Keys are read while they may be written, so they are held in atomics (with
+ * relaxed loads & stores) & T must be trivially copyable.
+ *
+ * Nodes are never merged or returned to the heap while the tree exists (like
+ * cstack's nodes), so a reader can never land in freed memory; leaves that
+ * run empty stay in place and fill up again. A tree that shrinks therefore
+ * keeps it's peak node count.
+ */
+template <typename T>
+class cbtree
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "concurrent B+tree keys must be trivially copyable");
+
+    typedef cbtree_leaf<T>  leaf;  ///< leaf node type
+    typedef cbtree_inner<T> inner; ///< inner node type
+
+public:
+
+    /**
+     * @brief Constructor.
+     */
+    cbtree()
+    {
+        p_root.store(leaf_create(), std::memory_order_relaxed);
+
+        num_values.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Destructor (no other thread may access tree any more).
+     */
+    ~cbtree()
+    {
+        cbtree_delete(p_root.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief Add key to set.
+     *
+     * @param[in] value: Value.
+     *
+     * @retval  true if key added.
+     * @retval false if key already in set.
+     */
+    bool add(const T &value)
+    {
+        bool added = false;
+
+        while (add_attempt(value, &added) == false)
+        {
+            // restart from root
+        }
+
+        if (added)
+        {
+            num_values.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        return added;
+    }
+
+    /**
+     * @brief Is key in set? (takes no locks)
+     *
+     * @param[in] value: Value.
+     *
+     * @retval  true if key found.
+     * @retval false if key not found.
+     */
+    bool contains(const T &value) const
+    {
+        cbtree_node<T> *p_node;
+
+        uint64_t version;
+
+        bool found;
+
+        while (true)
+        {
+            if (descend(value, &p_node, &version) == false)
+            {
+                continue;
+            }
+
+            found = (leaf_find(static_cast<leaf *>(p_node), value) >= 0);
+
+            if (validate(p_node, version))
+            {
+                return found;
+            }
+        }
+    }
+
+    /**
+     * @brief Remove key from set (locks only the key's leaf).
+     *
+     * @param[in] value: Value.
+     *
+     * @retval  true if key removed.
+     * @retval false if key not found.
+     */
+    bool remove(const T &value)
+    {
+        cbtree_node<T> *p_node;
+
+        leaf *p_leaf;
+
+        uint64_t version;
+
+        int index;
+        int num_keys;
+        int ii;
+
+        while ((descend(value, &p_node, &version) == false) ||
+               (lock(p_node, version) == false))
+        {
+            // restart from root
+        }
+
+        p_leaf = static_cast<leaf *>(p_node);
+
+        index = leaf_find(p_leaf, value);
+
+        if (index >= 0)
+        {
+            num_keys = p_leaf->num_keys.load(std::memory_order_relaxed);
+
+            for (ii = index; ii < num_keys - 1; ii++)
+            {
+                p_leaf->keys[ii].store(
+                    p_leaf->keys[ii + 1].load(std::memory_order_relaxed),
+                    std::memory_order_relaxed);
+            }
+
+            p_leaf->num_keys.store(num_keys - 1, std::memory_order_relaxed);
+        }
+
+        unlock(p_node);
+
+        if (index < 0)
+        {
+            return false;
+        }
+
+        num_values.fetch_sub(1, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    /**
+     * @brief Get number of keys in set (exact only while no other thread is
+     *        adding or removing keys).
+     *
+     * @retval Number of keys.
+     */
+    int size() const
+    {
+        return num_values.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Is set empty? (see size())
+     *
+     * @retval  true if set is empty
+     * @retval false if set is not empty
+     */
+    bool is_empty() const
+    {
+        return (size() == 0) ? true : false;
+    }
+
+    /**
+     * @brief Verify tree (no other thread may access it meanwhile): keys
+     *        strictly increasing & within their separators, no node locked,
+     *        all leaves at same depth, and number of keys correct.
+     *
+     * @retval  true if B+tree is correct
+     * @retval false if B+tree is incorrect
+     */
+    bool verify() const
+    {
+        int leaf_depth = -1;
+        int count      = 0;
+
+        if (verify_subtree(p_root.load(std::memory_order_relaxed), 0, NULL,
+                           NULL, &leaf_depth, &count) == false)
+        {
+            return false;
+        }
+
+        return count == size();
+    }
+
+private:
+
+    /**
+     * @brief Descend from root to key's leaf without locking (lock coupling:
+     *        each node's version is checked again once it's child's version
+     *        has been noted).
+     *
+     * @param[in]  value:     Value.
+     * @param[out] pp_node:   Pointer to pointer to leaf.
+     * @param[out] p_version: Pointer to leaf's version (noted while it
+     *                        covered value's key range).
+     *
+     * @retval  true if leaf found.
+     * @retval false if a node changed on the way (restart).
+     */
+    bool descend(const T &value, cbtree_node<T> **pp_node,
+                 uint64_t *p_version) const
+    {
+        cbtree_node<T> *p_node = p_root.load(std::memory_order_acquire);
+        cbtree_node<T> *p_child;
+
+        uint64_t version;
+        uint64_t version_child;
+
+        // a split root is still a valid node, so make sure it is still root
+
+        if ((read_lock(p_node, &version) == false) ||
+            (p_node != p_root.load(std::memory_order_acquire)))
+        {
+            return false;
+        }
+
+        while (p_node->is_leaf == false)
+        {
+            p_child = child_find(static_cast<inner *>(p_node), value);
+
+            if ((validate(p_node, version) == false) ||
+                (read_lock(p_child, &version_child) == false) ||
+                (validate(p_node, version) == false))
+            {
+                return false;
+            }
+
+            p_node  = p_child;
+            version = version_child;
+        }
+
+        *pp_node   = p_node;
+        *p_version = version;
+
+        return true;
+    }
+
+    /**
+     * @brief Try to add key to set: descend like descend(), splitting full
+     *        nodes on the way (which restarts the descent).
+     *
+     * @param[in]  value:   Value.
+     * @param[out] p_added: Pointer to whether key was added (if it's leaf was
+     *                      reached).
+     *
+     * @retval  true if key's leaf was reached (& key added if not present).
+     * @retval false if a node was split or changed on the way (restart).
+     */
+    bool add_attempt(const T &value, bool *p_added)
+    {
+        cbtree_node<T> *p_node   = p_root.load(std::memory_order_acquire);
+        cbtree_node<T> *p_parent = NULL;
+        cbtree_node<T> *p_child;
+
+        uint64_t version;
+        uint64_t version_parent = 0;
+        uint64_t version_child;
+
+        if ((read_lock(p_node, &version) == false) ||
+            (p_node != p_root.load(std::memory_order_acquire)))
+        {
+            return false;
+        }
+
+        while (true)
+        {
+            if (p_node->num_keys.load(std::memory_order_relaxed) ==
+                (p_node->is_leaf ? leaf::capacity : inner::capacity))
+            {
+                split(p_node, version, p_parent, version_parent);
+
+                return false;
+            }
+
+            if (p_node->is_leaf)
+            {
+                break;
+            }
+
+            p_child = child_find(static_cast<inner *>(p_node), value);
+
+            if ((validate(p_node, version) == false) ||
+                (read_lock(p_child, &version_child) == false) ||
+                (validate(p_node, version) == false))
+            {
+                return false;
+            }
+
+            p_parent       = p_node;
+            version_parent = version;
+
+            p_node  = p_child;
+            version = version_child;
+        }
+
+        if (lock(p_node, version) == false)
+        {
+            return false;
+        }
+
+        *p_added = leaf_insert(static_cast<leaf *>(p_node), value);
+
+        unlock(p_node);
+
+        return true;
+    }
+
+    /**
+     * @brief Split full node (locking it & it's parent, which is not full,
+     *        since full nodes are split on the way down). Does nothing if
+     *        either node changed since it's version was noted.
+     *
+     * @param[in,out] p_node:         Pointer to full node.
+     * @param[in]     version:        Node's noted version.
+     * @param[in,out] p_parent:       Pointer to parent node (NULL: root).
+     * @param[in]     version_parent: Parent's noted version.
+     */
+    void split(cbtree_node<T> *p_node, uint64_t version,
+               cbtree_node<T> *p_parent, uint64_t version_parent)
+    {
+        cbtree_node<T> *p_sibling;
+        inner          *p_inner;
+
+        T separator;
+
+        if ((p_parent != NULL) && (lock(p_parent, version_parent) == false))
+        {
+            return;
+        }
+
+        if (lock(p_node, version) == false)
+        {
+            if (p_parent != NULL)
+            {
+                unlock(p_parent);
+            }
+
+            return;
+        }
+
+        if ((p_parent == NULL) &&
+            (p_node != p_root.load(std::memory_order_relaxed)))
+        {
+            // root was split meanwhile: node has a parent now
+
+            unlock(p_node);
+
+            return;
+        }
+
+        if (p_node->is_leaf)
+        {
+            p_sibling = leaf_split(static_cast<leaf *>(p_node), &separator);
+        }
+        else
+        {
+            p_sibling = inner_split(static_cast<inner *>(p_node), &separator);
+        }
+
+        if (p_parent != NULL)
+        {
+            inner_insert(static_cast<inner *>(p_parent), separator, p_sibling);
+
+            unlock(p_node);
+
+            unlock(p_parent);
+
+            return;
+        }
+
+        // new root (old root stays locked until new one is published)
+
+        p_inner = inner_create();
+
+        p_inner->keys[0].store(separator, std::memory_order_relaxed);
+
+        p_inner->p_children[0].store(p_node, std::memory_order_relaxed);
+        p_inner->p_children[1].store(p_sibling, std::memory_order_relaxed);
+
+        p_inner->num_keys.store(1, std::memory_order_relaxed);
+
+        p_root.store(p_inner, std::memory_order_release);
+
+        unlock(p_node);
+    }
+
+    /**
+     * @brief Note node's version, unless node is locked.
+     *
+     * @param[in]  p_node:    Pointer to node structure.
+     * @param[out] p_version: Pointer to version.
+     *
+     * @retval  true if version noted.
+     * @retval false if node is locked (restart).
+     */
+    static bool read_lock(const cbtree_node<T> *p_node, uint64_t *p_version)
+    {
+        *p_version = p_node->version.load(std::memory_order_acquire);
+
+        if (*p_version & 1)
+        {
+            std::this_thread::yield(); // give lock holder a chance to finish
+
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Check that node is unchanged since it's version was noted, i.e.
+     *        that everything read from it since then is consistent.
+     *
+     * @param[in] p_node:  Pointer to node structure.
+     * @param[in] version: Noted version.
+     *
+     * @retval  true if node is unchanged.
+     * @retval false if node changed (restart).
+     */
+    static bool validate(const cbtree_node<T> *p_node, uint64_t version)
+    {
+        // keep preceding (relaxed) reads of node before version check
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        return p_node->version.load(std::memory_order_relaxed) == version;
+    }
+
+    /**
+     * @brief Lock node, unless it changed since it's version was noted.
+     *
+     * @param[in,out] p_node:  Pointer to node structure.
+     * @param[in]     version: Noted version.
+     *
+     * @retval  true if node locked.
+     * @retval false if node changed (restart).
+     */
+    static bool lock(cbtree_node<T> *p_node, uint64_t version)
+    {
+        if (p_node->version.compare_exchange_strong(version, version + 1,
+                                                    std::memory_order_acquire,
+                                                    std::memory_order_relaxed)
+            == false)
+        {
+            return false;
+        }
+
+        // keep following (relaxed) writes to node after lock, so that a
+        // reader that sees any of them also sees node locked
+
+        std::atomic_thread_fence(std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+     * @brief Unlock node (publishing a new version).
+     *
+     * @param[in,out] p_node: Pointer to node structure.
+     */
+    static void unlock(cbtree_node<T> *p_node)
+    {
+        p_node->version.fetch_add(1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Find child whose sub-tree covers value (binary search for first
+     *        separator greater than value; result may be inconsistent until
+     *        node is validated).
+     *
+     * @param[in] p_inner: Pointer to inner node structure.
+     * @param[in] value:   Value.
+     *
+     * @retval Pointer to child node.
+     */
+    static cbtree_node<T> *child_find(const inner *p_inner, const T &value)
+    {
+        int num_keys = p_inner->num_keys.load(std::memory_order_relaxed);
+        int first    = 0;
+        int half;
+
+        while (num_keys > 0)
+        {
+            half = num_keys / 2;
+
+            if (!(value <
+                  p_inner->keys[first + half].load(std::memory_order_relaxed)))
+            {
+                first += half + 1;
+
+                num_keys -= half + 1;
+            }
+            else
+            {
+                num_keys = half;
+            }
+        }
+
+        return p_inner->p_children[first].load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Find first key not less than value in node (binary search).
+     *
+     * @param[in] p_keys:   Pointer to keys (sorted).
+     * @param[in] num_keys: Number of keys.
+     * @param[in] value:    Value.
+     *
+     * @retval Index of first key >= value (num_keys if none).
+     */
+    static int lower_bound(const std::atomic<T> *p_keys, int num_keys,
+                           const T &value)
+    {
+        int first = 0;
+        int half;
+
+        while (num_keys > 0)
+        {
+            half = num_keys / 2;
+
+            if (p_keys[first + half].load(std::memory_order_relaxed) < value)
+            {
+                first += half + 1;
+
+                num_keys -= half + 1;
+            }
+            else
+            {
+                num_keys = half;
+            }
+        }
+
+        return first;
+    }
+
+    /**
+     * @brief Find key in leaf.
+     *
+     * @param[in] p_leaf: Pointer to leaf structure.
+     * @param[in] value:  Value.
+     *
+     * @retval -1 if key not found.
+     * @retval Index of key.
+     */
+    static int leaf_find(const leaf *p_leaf, const T &value)
+    {
+        int num_keys = p_leaf->num_keys.load(std::memory_order_relaxed);
+        int index    = lower_bound(p_leaf->keys, num_keys, value);
+
+        if ((index < num_keys) &&
+            (p_leaf->keys[index].load(std::memory_order_relaxed) == value))
+        {
+            return index;
+        }
+
+        return -1;
+    }
+
+    /**
+     * @brief Insert key into (locked, not full) leaf, unless already there.
+     *
+     * @param[in,out] p_leaf: Pointer to leaf structure.
+     * @param[in]     value:  Value.
+     *
+     * @retval  true if key inserted.
+     * @retval false if key already in leaf.
+     */
+    static bool leaf_insert(leaf *p_leaf, const T &value)
+    {
+        int num_keys = p_leaf->num_keys.load(std::memory_order_relaxed);
+        int index    = lower_bound(p_leaf->keys, num_keys, value);
+        int ii;
+
+        if ((index < num_keys) &&
+            (p_leaf->keys[index].load(std::memory_order_relaxed) == value))
+        {
+            return false;
+        }
+
+        for (ii = num_keys; ii > index; ii--)
+        {
+            p_leaf->keys[ii].store(
+                p_leaf->keys[ii - 1].load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
+        }
+
+        p_leaf->keys[index].store(value, std::memory_order_relaxed);
+
+        p_leaf->num_keys.store(num_keys + 1, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    /**
+     * @brief Insert separator & new right child into (locked, not full)
+     *        inner node.
+     *
+     * @param[in,out] p_inner:   Pointer to inner node structure.
+     * @param[in]     separator: Separator (new child's smallest key).
+     * @param[in]     p_child:   Pointer to new child node.
+     */
+    static void inner_insert(inner *p_inner, const T &separator,
+                             cbtree_node<T> *p_child)
+    {
+        int num_keys = p_inner->num_keys.load(std::memory_order_relaxed);
+        int index    = lower_bound(p_inner->keys, num_keys, separator);
+        int ii;
+
+        for (ii = num_keys; ii > index; ii--)
+        {
+            p_inner->keys[ii].store(
+                p_inner->keys[ii - 1].load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
+
+            p_inner->p_children[ii + 1].store(
+                p_inner->p_children[ii].load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
+        }
+
+        p_inner->keys[index].store(separator, std::memory_order_relaxed);
+
+        // release: new child's contents are visible to whoever finds it
+
+        p_inner->p_children[index + 1].store(p_child,
+                                             std::memory_order_release);
+
+        p_inner->num_keys.store(num_keys + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Split (locked, full) leaf: right half moves to new leaf.
+     *
+     * @param[in,out] p_leaf:      Pointer to leaf structure.
+     * @param[out]    p_separator: Pointer to separator (new leaf's first key).
+     *
+     * @retval Pointer to new leaf structure.
+     */
+    static leaf *leaf_split(leaf *p_leaf, T *p_separator)
+    {
+        leaf *p_right = leaf_create();
+
+        int num_left = leaf::capacity / 2;
+        int ii;
+
+        for (ii = num_left; ii < leaf::capacity; ii++)
+        {
+            p_right->keys[ii - num_left].store(
+                p_leaf->keys[ii].load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
+        }
+
+        p_right->num_keys.store(leaf::capacity - num_left,
+                                std::memory_order_relaxed);
+
+        p_leaf->num_keys.store(num_left, std::memory_order_relaxed);
+
+        *p_separator = p_right->keys[0].load(std::memory_order_relaxed);
+
+        return p_right;
+    }
+
+    /**
+     * @brief Split (locked, full) inner node: middle separator moves up,
+     *        separators & children right of it move to new inner node.
+     *
+     * @param[in,out] p_inner:     Pointer to inner node structure.
+     * @param[out]    p_separator: Pointer to middle separator.
+     *
+     * @retval Pointer to new inner node structure.
+     */
+    static inner *inner_split(inner *p_inner, T *p_separator)
+    {
+        inner *p_right = inner_create();
+
+        int middle = inner::capacity / 2;
+        int ii;
+
+        for (ii = middle + 1; ii < inner::capacity; ii++)
+        {
+            p_right->keys[ii - middle - 1].store(
+                p_inner->keys[ii].load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
+        }
+
+        for (ii = middle + 1; ii <= inner::capacity; ii++)
+        {
+            p_right->p_children[ii - middle - 1].store(
+                p_inner->p_children[ii].load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
+        }
+
+        p_right->num_keys.store(inner::capacity - middle - 1,
+                                std::memory_order_relaxed);
+
+        p_inner->num_keys.store(middle, std::memory_order_relaxed);
+
+        *p_separator = p_inner->keys[middle].load(std::memory_order_relaxed);
+
+        return p_right;
+    }
+
+    /**
+     * @brief Recursively verify sub-tree (recursion depth is tree's height).
+     *
+     * @param[in]     p_node:       Pointer to sub-tree's root node.
+     * @param[in]     depth:        Depth of sub-tree's root node.
+     * @param[in]     p_lower:      Pointer to lower bound (NULL: none).
+     * @param[in]     p_upper:      Pointer to upper bound (NULL: none).
+     * @param[in,out] p_leaf_depth: Pointer to depth of leaves (-1: unknown).
+     * @param[in,out] p_count:      Pointer to number of keys in leaves.
+     *
+     * @retval  true if sub-tree is correct
+     * @retval false if sub-tree is incorrect
+     */
+    bool verify_subtree(const cbtree_node<T> *p_node, int depth,
+                        const T *p_lower, const T *p_upper, int *p_leaf_depth,
+                        int *p_count) const
+    {
+        const std::atomic<T> *p_keys;
+
+        int num_keys = p_node->num_keys.load(std::memory_order_relaxed);
+        int ii;
+
+        T key;
+        T key_prev = T();
+        T lower    = T();
+        T upper    = T();
+
+        if (p_node->version.load(std::memory_order_relaxed) & 1)
+        {
+            return false;
+        }
+
+        if (p_node->is_leaf)
+        {
+            if ((*p_leaf_depth >= 0) && (*p_leaf_depth != depth))
+            {
+                return false;
+            }
+
+            *p_leaf_depth = depth;
+
+            *p_count += num_keys;
+
+            p_keys = static_cast<const leaf *>(p_node)->keys;
+        }
+        else
+        {
+            if (num_keys < 1)
+            {
+                return false;
+            }
+
+            p_keys = static_cast<const inner *>(p_node)->keys;
+        }
+
+        for (ii = 0; ii < num_keys; ii++)
+        {
+            key = p_keys[ii].load(std::memory_order_relaxed);
+
+            if (((ii > 0) && !(key_prev < key)) ||
+                ((p_lower != NULL) && (key < *p_lower)) ||
+                ((p_upper != NULL) && !(key < *p_upper)))
+            {
+                return false;
+            }
+
+            key_prev = key;
+        }
+
+        if (p_node->is_leaf)
+        {
+            return true;
+        }
+
+        for (ii = 0; ii <= num_keys; ii++)
+        {
+            if (ii > 0)
+            {
+                lower = p_keys[ii - 1].load(std::memory_order_relaxed);
+            }
+
+            if (ii < num_keys)
+            {
+                upper = p_keys[ii].load(std::memory_order_relaxed);
+            }
+
+            if (verify_subtree(static_cast<const inner *>(p_node)->
+                               p_children[ii].load(std::memory_order_relaxed),
+                               depth + 1,
+                               (ii > 0) ? &lower : p_lower,
+                               (ii < num_keys) ? &upper : p_upper,
+                               p_leaf_depth, p_count) == false)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Allocate (cache line aligned) node.
+     *
+     * @param[in] size: Node size in bytes.
+     *
+     * @retval Pointer to node memory.
+     */
+    static void *node_alloc(size_t size)
+    {
+        void *p_memory = NULL;
+
+        if (posix_memalign(&p_memory, CBTREE_CACHE_LINE_SIZE, size) != 0)
+        {
+            throw std::bad_alloc();
+        }
+
+        return p_memory;
+    }
+
+    /**
+     * @brief Create (empty, unlocked) leaf.
+     *
+     * @retval Pointer to new leaf structure.
+     */
+    static leaf *leaf_create()
+    {
+        leaf *p_leaf = new (node_alloc(sizeof(leaf))) leaf;
+
+        p_leaf->version.store(0, std::memory_order_relaxed);
+        p_leaf->num_keys.store(0, std::memory_order_relaxed);
+
+        p_leaf->is_leaf = true;
+
+        return p_leaf;
+    }
+
+    /**
+     * @brief Create (empty, unlocked) inner node.
+     *
+     * @retval Pointer to new inner node structure.
+     */
+    static inner *inner_create()
+    {
+        inner *p_inner = new (node_alloc(sizeof(inner))) inner;
+
+        int ii;
+
+        p_inner->version.store(0, std::memory_order_relaxed);
+        p_inner->num_keys.store(0, std::memory_order_relaxed);
+
+        p_inner->is_leaf = false;
+
+        // an inconsistent read may pick any child slot: never a stray pointer
+
+        for (ii = 0; ii <= inner::capacity; ii++)
+        {
+            p_inner->p_children[ii].store(NULL, std::memory_order_relaxed);
+        }
+
+        return p_inner;
+    }
+
+    /**
+     * @brief Recursively delete sub-tree (recursion depth is tree's height).
+     *
+     * @param[in,out] p_node: Pointer to sub-tree's root node.
+     */
+    static void cbtree_delete(cbtree_node<T> *p_node)
+    {
+        int ii;
+
+        if (p_node->is_leaf)
+        {
+            static_cast<leaf *>(p_node)->~leaf();
+        }
+        else
+        {
+            inner *p_inner = static_cast<inner *>(p_node);
+
+            for (ii = 0;
+                 ii <= p_inner->num_keys.load(std::memory_order_relaxed); ii++)
+            {
+                cbtree_delete(
+                    p_inner->p_children[ii].load(std::memory_order_relaxed));
+            }
+
+            p_inner->~inner();
+        }
+
+        free(p_node);
+    }
+
+    std::atomic<cbtree_node<T> *> p_root; ///< pointer to root node
+
+    std::atomic<int> num_values; ///< number of keys in set
+};
+
+#endif // #ifndef _CBTREE_H_
@@ -0,0 +1,534 @@
+/**
+ * @file  cstack.h
+ *
+ * @brief Concurrent (lock-free) stack class.
+ */
+
+#ifndef _CSTACK_H_
+
+#define _CSTACK_H_
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <type_traits>
+
+#define CSTACK_CACHE_LINE_SIZE   64 ///< cache line size in bytes
+#define CSTACK_ELIMINATION_SLOTS 8  ///< number of elimination array slots
+#define CSTACK_ELIMINATION_SPINS 64 ///< spins waiting for a pop to pair off
+
+#define CSTACK_POINTER_BITS 48 ///< significant bits in a user-space pointer
+
+/// concurrent stack node structure
+template <typename T>
+struct cstack_node {
+    std::atomic<T>                 value;  ///< node value
+    std::atomic<cstack_node<T> *> p_next; ///< pointer to next node
+};
+
+/// concurrent stack elimination slot (padded to a cache line)
+struct cstack_slot {
+    std::atomic<uint64_t> word; ///< tagged pointer to offered node
+
+    char pad[CSTACK_CACHE_LINE_SIZE - sizeof(std::atomic<uint64_t>)]; ///< pad
+};
+
+/**
+ * @brief Concurrent stack class.
+ *
+ * Treiber stack: push & pop are a single compare-and-swap on the top-of-stack
+ * word. To defeat ABA, that word holds a tagged pointer (node pointer in the
+ * low CSTACK_POINTER_BITS bits, modification counter in the rest).
+ *
+ * When the compare-and-swap fails because of contention, the thread visits a
+ * random slot of an elimination array instead: a push parks it's node there
+ * for a short while, and a pop that finds a parked node takes it, so the pair
+ * completes without touching the top of stack at all.
+ *
+ * Nodes are never returned to the heap while the stack exists; popped nodes
+ * go onto a (likewise tagged) free list and are reused by later pushes. That
+ * keeps a racing pop's read of a stale node's p_next valid.
+ *
+ * A peek may read a node's value while the node is being popped & reused
+ * by a push, so values are stored with atomic loads & stores (T must be
+ * trivially copyable, e.g. a pointer to a buffer) and the peek validates
+ * it's read afterwards.
+ */
+template <typename T>
+class cstack
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "concurrent stack values must be trivially copyable");
+
+public:
+
+    /**
+     * @brief Constructor.
+     */
+    cstack()
+    {
+        int ii;
+
+        top.store(0);
+
+        free_list.store(0);
+
+        for (ii = 0; ii < CSTACK_ELIMINATION_SLOTS; ii++)
+        {
+            slots[ii].word.store(0);
+        }
+    }
+
+    /**
+     * @brief Destructor (not thread-safe).
+     */
+    ~cstack()
+    {
+        cstack_node<T> *p_node;
+
+        while ((p_node = list_pop(top)) != NULL)
+        {
+            delete p_node;
+        }
+
+        while ((p_node = list_pop(free_list)) != NULL)
+        {
+            delete p_node;
+        }
+    }
+
+    /**
+     * @brief Push value onto stack.
+     *
+     * @param[in] value: Value.
+     */
+    void push(const T &value)
+    {
+        cstack_node<T> *p_node;
+
+        p_node = node_create();
+
+        value_store(p_node, value);
+
+        node_push(p_node);
+    }
+
+    /**
+     * @brief Pop value from stack.
+     *
+     * @retval Value at top of stack.
+     */
+    T pop()
+    {
+        T value;
+
+        bool popped = try_pop(value);
+
+        assert(popped);
+
+        (void)popped;
+
+        return value;
+    }
+
+    /**
+     * @brief Pop value from stack if stack is not empty.
+     *
+     * @param[out] value: Value at top of stack.
+     *
+     * @retval  true if value popped
+     * @retval false if stack is empty
+     */
+    bool try_pop(T &value)
+    {
+        cstack_node<T> *p_node = NULL;
+
+        while (true)
+        {
+            uint64_t word = top.load(std::memory_order_acquire);
+
+            if (pointer(word) == NULL)
+            {
+                return false;
+            }
+
+            if (list_pop_once(top, word, &p_node) ||
+                eliminate_pop(&p_node))
+            {
+                break;
+            }
+        }
+
+        value = p_node->value.load(std::memory_order_relaxed);
+
+        list_push(free_list, p_node);
+
+        return true;
+    }
+
+    /**
+     * @brief Peek value at top of stack.
+     *
+     * @retval Value at top of stack.
+     */
+    T peek()
+    {
+        T value;
+
+        bool peeked = try_peek(value);
+
+        assert(peeked);
+
+        (void)peeked;
+
+        return value;
+    }
+
+    /**
+     * @brief Peek value at top of stack if stack is not empty.
+     *
+     * The value is loaded, then the top of stack is re-read: if it's tagged
+     * pointer is unchanged, no pop happened meanwhile and the value is valid
+     * (seqlock-style); otherwise the load is retried. A push that reuses
+     * the node meanwhile fences before storing it's value (value_store()),
+     * so a peek that loads the new value is bound to see top changed.
+     *
+     * @param[out] value: Value at top of stack.
+     *
+     * @retval  true if value peeked
+     * @retval false if stack is empty
+     */
+    bool try_peek(T &value)
+    {
+        uint64_t word;
+
+        do
+        {
+            word = top.load(std::memory_order_acquire);
+
+            if (pointer(word) == NULL)
+            {
+                return false;
+            }
+
+            value = pointer(word)->value.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        while (top.load(std::memory_order_relaxed) != word);
+
+        return true;
+    }
+
+    /**
+     * @brief Is stack empty?
+     *
+     * @retval  true if stack is empty
+     * @retval false if stack is not empty
+     */
+    bool is_empty()
+    {
+        return pointer(top.load(std::memory_order_acquire)) == NULL;
+    }
+
+private:
+
+    /**
+     * @brief Build tagged pointer.
+     *
+     * @param[in] p_node: Pointer to node structure.
+     * @param[in] tag:    Tag (modification counter).
+     *
+     * @retval Tagged pointer.
+     */
+    static uint64_t tagged(cstack_node<T> *p_node, uint64_t tag)
+    {
+        return (tag << CSTACK_POINTER_BITS) | (uint64_t)(uintptr_t)p_node;
+    }
+
+    /**
+     * @brief Get pointer from tagged pointer.
+     *
+     * @param[in] word: Tagged pointer.
+     *
+     * @retval Pointer to node structure.
+     */
+    static cstack_node<T> *pointer(uint64_t word)
+    {
+        return reinterpret_cast<cstack_node<T> *>(
+            (uintptr_t)(word & ((1ULL << CSTACK_POINTER_BITS) - 1)));
+    }
+
+    /**
+     * @brief Get next tag for tagged pointer.
+     *
+     * @param[in] word: Tagged pointer.
+     *
+     * @retval Tag, incremented.
+     */
+    static uint64_t tag_next(uint64_t word)
+    {
+        return (word >> CSTACK_POINTER_BITS) + 1;
+    }
+
+    /**
+     * @brief Store value in (exclusively owned) node.
+     *
+     * @param[in,out] p_node: Pointer to node structure.
+     * @param[in]     value:  Value.
+     */
+    static void value_store(cstack_node<T> *p_node, const T &value)
+    {
+        // release: pairs with try_peek's acquire fence, so a peek that loads
+        // this value also sees the pop that freed node (node left top)
+
+        std::atomic_thread_fence(std::memory_order_release);
+
+        p_node->value.store(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Try to push node onto tagged list once.
+     *
+     * @param[in,out] head:   Tagged list head.
+     * @param[in]     word:   Expected (previously loaded) head.
+     * @param[in,out] p_node: Pointer to node structure.
+     *
+     * @retval  true if node pushed
+     * @retval false if head changed meanwhile
+     */
+    static bool list_push_once(std::atomic<uint64_t> &head, uint64_t word,
+                               cstack_node<T> *p_node)
+    {
+        p_node->p_next.store(pointer(word), std::memory_order_relaxed);
+
+        return head.compare_exchange_weak(word, tagged(p_node, tag_next(word)),
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Try to pop node from (non-empty) tagged list once.
+     *
+     * @param[in,out] head:    Tagged list head.
+     * @param[in]     word:    Expected (previously loaded) head.
+     * @param[out]    pp_node: Pointer to pointer to popped node.
+     *
+     * @retval  true if node popped
+     * @retval false if head changed meanwhile
+     */
+    static bool list_pop_once(std::atomic<uint64_t> &head, uint64_t word,
+                              cstack_node<T> **pp_node)
+    {
+        cstack_node<T> *p_next;
+
+        // node may already have been popped & recycled by another thread; it's
+        // memory stays valid and the tag makes the compare-and-swap fail then
+
+        p_next = pointer(word)->p_next.load(std::memory_order_relaxed);
+
+        if (head.compare_exchange_weak(word, tagged(p_next, tag_next(word)),
+                                       std::memory_order_acquire,
+                                       std::memory_order_relaxed))
+        {
+            *pp_node = pointer(word);
+
+            return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Push node onto tagged list.
+     *
+     * @param[in,out] head:   Tagged list head.
+     * @param[in,out] p_node: Pointer to node structure.
+     */
+    static void list_push(std::atomic<uint64_t> &head, cstack_node<T> *p_node)
+    {
+        while (!list_push_once(head, head.load(std::memory_order_relaxed),
+                               p_node))
+        {
+        }
+    }
+
+    /**
+     * @brief Pop node from tagged list.
+     *
+     * @param[in,out] head: Tagged list head.
+     *
+     * @retval NULL if list is empty.
+     * @retval Pointer to popped node.
+     */
+    static cstack_node<T> *list_pop(std::atomic<uint64_t> &head)
+    {
+        cstack_node<T> *p_node = NULL;
+
+        uint64_t word;
+
+        do
+        {
+            word = head.load(std::memory_order_acquire);
+
+            if (pointer(word) == NULL)
+            {
+                return NULL;
+            }
+        }
+        while (!list_pop_once(head, word, &p_node));
+
+        return p_node;
+    }
+
+    /**
+     * @brief Push node onto stack, falling back to elimination array while
+     *        top of stack is contended.
+     *
+     * @param[in,out] p_node: Pointer to node structure.
+     */
+    void node_push(cstack_node<T> *p_node)
+    {
+        while (!list_push_once(top, top.load(std::memory_order_relaxed),
+                               p_node))
+        {
+            if (eliminate_push(p_node))
+            {
+                break;
+            }
+        }
+    }
+
+    /**
+     * @brief Offer node to a concurrent pop through elimination array.
+     *
+     * @param[in,out] p_node: Pointer to node structure.
+     *
+     * @retval  true if a pop took node
+     * @retval false if no pop took node (node must be pushed normally)
+     */
+    bool eliminate_push(cstack_node<T> *p_node)
+    {
+        std::atomic<uint64_t> &word = slots[slot_index()].word;
+
+        uint64_t empty = word.load(std::memory_order_relaxed);
+        uint64_t offer;
+
+        int ii;
+
+        if (pointer(empty) != NULL)
+        {
+            return false;
+        }
+
+        offer = tagged(p_node, tag_next(empty));
+
+        if (!word.compare_exchange_strong(empty, offer,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed))
+        {
+            return false;
+        }
+
+        for (ii = 0; ii < CSTACK_ELIMINATION_SPINS; ii++)
+        {
+            if (word.load(std::memory_order_acquire) != offer)
+            {
+                return true;
+            }
+        }
+
+        // withdraw offer; if that fails, a pop took node in the meantime
+
+        return !word.compare_exchange_strong(offer,
+                                             tagged(NULL, tag_next(offer)),
+                                             std::memory_order_acquire,
+                                             std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Take node offered by a concurrent push from elimination array.
+     *
+     * @param[out] pp_node: Pointer to pointer to taken node.
+     *
+     * @retval  true if node taken
+     * @retval false if no node on offer
+     */
+    bool eliminate_pop(cstack_node<T> **pp_node)
+    {
+        std::atomic<uint64_t> &word = slots[slot_index()].word;
+
+        uint64_t offer = word.load(std::memory_order_acquire);
+
+        if (pointer(offer) == NULL)
+        {
+            return false;
+        }
+
+        if (!word.compare_exchange_strong(offer, tagged(NULL, tag_next(offer)),
+                                          std::memory_order_acquire,
+                                          std::memory_order_relaxed))
+        {
+            return false;
+        }
+
+        *pp_node = pointer(offer);
+
+        return true;
+    }
+
+    /**
+     * @brief Pick random elimination slot (per-thread xorshift generator).
+     *
+     * @retval Slot index.
+     */
+    static int slot_index()
+    {
+        static thread_local uint32_t state = 0;
+
+        if (state == 0)
+        {
+            state = (uint32_t)(uintptr_t)&state | 1;
+        }
+
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+
+        return (int)(state % CSTACK_ELIMINATION_SLOTS);
+    }
+
+    /**
+     * @brief Create node (recycled from free list if possible).
+     *
+     * @retval Pointer to node structure.
+     */
+    cstack_node<T> *node_create()
+    {
+        cstack_node<T> *p_node;
+
+        p_node = list_pop(free_list);
+
+        if (p_node == NULL)
+        {
+            p_node = new cstack_node<T>;
+
+            assert(((uintptr_t)p_node >> CSTACK_POINTER_BITS) == 0);
+        }
+
+        return p_node;
+    }
+
+    std::atomic<uint64_t> top; ///< tagged pointer to top node
+
+    char pad_top[CSTACK_CACHE_LINE_SIZE]; ///< keep top on it's own line
+
+    std::atomic<uint64_t> free_list; ///< tagged pointer to first free node
+
+    char pad_free_list[CSTACK_CACHE_LINE_SIZE]; ///< keep free list apart
+
+    cstack_slot slots[CSTACK_ELIMINATION_SLOTS]; ///< elimination array
+};
+
+#endif // #ifndef _CSTACK_H_
@@ -8,12 +8,29 @@
 
 #define _DLLIST_H_
 
+#include <stddef.h>
+#include <utility>
+
 /// doubly-linked list node structure
 template <typename T>
 struct dllist_node {
     T               value;  ///< node value
     dllist_node<T> *p_next; ///< pointer to next node
     dllist_node<T> *p_prev; ///< pointer to previous node
+
+    /**
+     * @brief Constructor, constructing value in place.
+     *
+     * @param[in] p_next: Pointer to next node.
+     * @param[in] p_prev: Pointer to previous node.
+     * @param[in] args:   Arguments for value's constructor.
+     */
+    template <typename... Args>
+    dllist_node(dllist_node<T> *p_next, dllist_node<T> *p_prev,
+                Args &&... args) :
+        value(std::forward<Args>(args)...), p_next(p_next), p_prev(p_prev)
+    {
+    }
 };
 
 /// doubly-linked list class
@@ -63,11 +80,32 @@ public:
      *
      * @param[in] value: Value.
      */
-    void add_head(T value)
+    void add_head(const T &value)
+    {
+        emplace_head(value);
+    }
+
+    /**
+     * @brief Add node with associated value to head of list (moving value).
+     *
+     * @param[in,out] value: Value.
+     */
+    void add_head(T &&value)
+    {
+        emplace_head(std::move(value));
+    }
+
+    /**
+     * @brief Add node to head of list, constructing it's value in place.
+     *
+     * @param[in] args: Arguments for value's constructor.
+     */
+    template <typename... Args>
+    void emplace_head(Args &&... args)
     {
         dllist_node<T> *p_node = NULL;
 
-        p_node = node_create(value);
+        p_node = node_create(std::forward<Args>(args)...);
 
         p_node->p_next = p_head;
         p_node->p_prev = NULL;
@@ -92,11 +130,32 @@ public:
      *
      * @param[in] value: Value.
      */
-    void add_tail(T value)
+    void add_tail(const T &value)
+    {
+        emplace_tail(value);
+    }
+
+    /**
+     * @brief Add node with associated value to tail of list (moving value).
+     *
+     * @param[in,out] value: Value.
+     */
+    void add_tail(T &&value)
+    {
+        emplace_tail(std::move(value));
+    }
+
+    /**
+     * @brief Add node to tail of list, constructing it's value in place.
+     *
+     * @param[in] args: Arguments for value's constructor.
+     */
+    template <typename... Args>
+    void emplace_tail(Args &&... args)
     {
         dllist_node<T> *p_node = NULL;
 
-        p_node = node_create(value);
+        p_node = node_create(std::forward<Args>(args)...);
 
         if (num_nodes)
         {
@@ -116,6 +175,50 @@ public:
         num_nodes++;
     }
 
+    /**
+     * @brief Move value out of head node & delete node.
+     *
+     * @param[out] value: Value at head of list.
+     *
+     * @retval  true if value popped
+     * @retval false if list is empty
+     */
+    bool pop_head(T &value)
+    {
+        if (num_nodes == 0)
+        {
+            return false;
+        }
+
+        value = std::move(p_head->value);
+
+        delete_head();
+
+        return true;
+    }
+
+    /**
+     * @brief Move value out of tail node & delete node.
+     *
+     * @param[out] value: Value at tail of list.
+     *
+     * @retval  true if value popped
+     * @retval false if list is empty
+     */
+    bool pop_tail(T &value)
+    {
+        if (num_nodes == 0)
+        {
+            return false;
+        }
+
+        value = std::move(p_tail->value);
+
+        delete_tail();
+
+        return true;
+    }
+
     /**
      * @brief Delete node at head of list.
      */
@@ -179,7 +282,7 @@ public:
      *
      * @param[in] value: Value.
      */
-    void remove(T value)
+    void remove(const T &value)
     {
         dllist_node<T> *p_node;
 
@@ -229,21 +332,18 @@ public:
 private:
 
     /**
-     * @brief Create node with associated value.
+     * @brief Create node, constructing it's value in place.
      *
-     * @param[in] value: Value.
+     * @param[in] args: Arguments for value's constructor.
      *
      * @retval Pointer to new node structure.
      */
-    dllist_node<T> *node_create(T value)
+    template <typename... Args>
+    dllist_node<T> *node_create(Args &&... args)
     {
         dllist_node<T> *p_node = NULL;
 
-        p_node = new dllist_node<T>;
-
-        p_node->value  = value;
-        p_node->p_next = NULL;
-        p_node->p_prev = NULL;
+        p_node = new dllist_node<T>(NULL, NULL, std::forward<Args>(args)...);
 
         return p_node;
     }
@@ -265,7 +365,7 @@ private:
      *
      * @retval Pointer to node structure.
      */
-    dllist_node<T> *node_find(T value)
+    dllist_node<T> *node_find(const T &value)
     {
         dllist_node<T> *p_node;
 
@@ -0,0 +1,566 @@
+/**
+ * @file  dpqueue.h
+ *
+ * @brief Priority queue class (array-backed d-ary heap).
+ */
+
+#ifndef _DPQUEUE_H_
+
+#define _DPQUEUE_H_
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+
+#define DPQUEUE_CAPACITY_MIN   16 ///< minimum number of items allocated
+#define DPQUEUE_CACHE_LINE_SIZE 64 ///< cache line size in bytes
+
+/**
+ * @brief Find index of smallest child (first one, if several are equal).
+ *
+ * @param[in] p_children:   Pointer to first child.
+ * @param[in] num_children: Number of children.
+ *
+ * @retval Index of smallest child (relative to first child).
+ */
+template <typename T>
+int dpqueue_min_child_scalar(const T *p_children, int num_children)
+{
+    int index = 0;
+    int ii;
+
+    for (ii = 1; ii < num_children; ii++)
+    {
+        if (p_children[ii] < p_children[index])
+        {
+            index = ii;
+        }
+    }
+
+    return index;
+}
+
+/// smallest-child selection (scalar version)
+template <typename T, int D>
+struct dpqueue_min_child {
+    /**
+     * @brief Find index of smallest child (first one, if several are equal).
+     *
+     * @param[in] p_children:   Pointer to first child.
+     * @param[in] num_children: Number of children (1..D).
+     *
+     * @retval Index of smallest child (relative to first child).
+     */
+    static int find(const T *p_children, int num_children)
+    {
+        return dpqueue_min_child_scalar(p_children, num_children);
+    }
+};
+
+#if defined(__SSE2__)
+
+/**
+ * @brief Smallest-child selection over a full set of 8 32-bit children (two
+ *        vectors): reduce to the minimum, broadcast it, and pick the first
+ *        lane that equals it.
+ *
+ * Int32 / uint32 / float only differ in how two vectors are min-ed and
+ * compared, which the Ops class provides.
+ */
+template <typename T, typename Ops>
+struct dpqueue_min_child_8x32 {
+    /**
+     * @brief Find index of smallest child (first one, if several are equal).
+     *
+     * @param[in] p_children:   Pointer to first child.
+     * @param[in] num_children: Number of children (1..8).
+     *
+     * @retval Index of smallest child (relative to first child).
+     */
+    static int find(const T *p_children, int num_children)
+    {
+        __m128i lo, hi, min;
+
+        int mask;
+
+        if (num_children < 8)
+        {
+            return dpqueue_min_child_scalar(p_children, num_children);
+        }
+
+        lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_children));
+        hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_children + 4));
+
+        min = Ops::min(lo, hi);
+        min = Ops::min(min, _mm_shuffle_epi32(min, _MM_SHUFFLE(1, 0, 3, 2)));
+        min = Ops::min(min, _mm_shuffle_epi32(min, _MM_SHUFFLE(2, 3, 0, 1)));
+
+        mask = _mm_movemask_ps(_mm_castsi128_ps(Ops::cmpeq(lo, min))) |
+               (_mm_movemask_ps(_mm_castsi128_ps(Ops::cmpeq(hi, min))) << 4);
+
+        if (mask == 0)
+        {
+            // unordered values (NaN): let scalar version decide
+
+            return dpqueue_min_child_scalar(p_children, num_children);
+        }
+
+        return __builtin_ctz(mask);
+    }
+};
+
+/// vector operations: signed 32-bit integers
+struct dpqueue_ops_i32 {
+    static __m128i min(__m128i a, __m128i b)
+    {
+#if defined(__SSE4_1__)
+        return _mm_min_epi32(a, b);
+#else
+        __m128i lt = _mm_cmplt_epi32(a, b);
+
+        return _mm_or_si128(_mm_and_si128(lt, a), _mm_andnot_si128(lt, b));
+#endif
+    }
+
+    static __m128i cmpeq(__m128i a, __m128i b) { return _mm_cmpeq_epi32(a, b); }
+};
+
+/// vector operations: unsigned 32-bit integers
+struct dpqueue_ops_u32 {
+    static __m128i min(__m128i a, __m128i b)
+    {
+#if defined(__SSE4_1__)
+        return _mm_min_epu32(a, b);
+#else
+        // flip sign bits, so that a signed compare orders unsigned values
+
+        __m128i bias = _mm_set1_epi32((int)0x80000000);
+        __m128i lt   = _mm_cmplt_epi32(_mm_xor_si128(a, bias),
+                                       _mm_xor_si128(b, bias));
+
+        return _mm_or_si128(_mm_and_si128(lt, a), _mm_andnot_si128(lt, b));
+#endif
+    }
+
+    static __m128i cmpeq(__m128i a, __m128i b) { return _mm_cmpeq_epi32(a, b); }
+};
+
+/// vector operations: single-precision floating point
+struct dpqueue_ops_f32 {
+    static __m128i min(__m128i a, __m128i b)
+    {
+        return _mm_castps_si128(_mm_min_ps(_mm_castsi128_ps(a),
+                                           _mm_castsi128_ps(b)));
+    }
+
+    static __m128i cmpeq(__m128i a, __m128i b)
+    {
+        return _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(a),
+                                             _mm_castsi128_ps(b)));
+    }
+};
+
+/// pick vector operations for T (void if none)
+template <typename T>
+struct dpqueue_ops {
+    typedef typename std::conditional<
+        std::is_same<T, float>::value, dpqueue_ops_f32,
+        typename std::conditional<
+            std::is_integral<T>::value && (sizeof(T) == 4),
+            typename std::conditional<std::is_signed<T>::value,
+                                      dpqueue_ops_i32,
+                                      dpqueue_ops_u32>::type,
+            void>::type>::type type; ///< vector operations
+};
+
+/// smallest-child selection (vector version for d = 8, where available)
+template <typename T>
+struct dpqueue_min_child<T, 8> {
+    /**
+     * @brief Find index of smallest child (first one, if several are equal).
+     *
+     * @param[in] p_children:   Pointer to first child.
+     * @param[in] num_children: Number of children (1..8).
+     *
+     * @retval Index of smallest child (relative to first child).
+     */
+    static int find(const T *p_children, int num_children)
+    {
+        return find(p_children, num_children,
+                    (typename dpqueue_ops<T>::type *)NULL);
+    }
+
+private:
+
+    /// vector version
+    template <typename Ops>
+    static int find(const T *p_children, int num_children, Ops *)
+    {
+        return dpqueue_min_child_8x32<T, Ops>::find(p_children, num_children);
+    }
+
+    /// scalar version (no vector operations for T)
+    static int find(const T *p_children, int num_children, void *)
+    {
+        return dpqueue_min_child_scalar(p_children, num_children);
+    }
+};
+
+#endif // #if defined(__SSE2__)
+
+/**
+ * @brief Priority queue class (array-backed d-ary heap).
+ *
+ * Same interface as pqueue, but enqueue & dequeue are O(log n): items live in
+ * one contiguous array laid out as a d-ary min-heap, so a node's children are
+ * adjacent and, for 32-bit arithmetic types, the smallest child is selected
+ * with SIMD. The array is cache line aligned, with the root padded so that
+ * the first child group starts a line: if the item size divides a cache
+ * line, child groups whose size does too (with D = 8 and 4-byte items, 32
+ * bytes: half a line) never straddle two lines.
+ *
+ * Unlike pqueue, items with equal priority are not dequeued in FIFO order.
+ */
+template <typename T, int D = 4>
+class dpqueue
+{
+    static_assert(D >= 2, "d-ary heap needs at least 2 children per node");
+
+    /// number of (unused) slots before root, so that item 1 starts a line
+    static const int ROOT_OFFSET =
+        (DPQUEUE_CACHE_LINE_SIZE % (int)sizeof(T) == 0) ?
+        (DPQUEUE_CACHE_LINE_SIZE / (int)sizeof(T) - 1) : 0;
+
+public:
+
+    /**
+     * @brief Constructor.
+     */
+    dpqueue()
+    {
+        p_items = NULL;
+
+        num_items = 0;
+        capacity  = 0;
+    }
+
+    /**
+     * @brief Destructor.
+     */
+    ~dpqueue()
+    {
+        items_delete(p_items, capacity);
+    }
+
+    /**
+     * @brief Enqueue value.
+     *
+     * @param[in] value: Value.
+     */
+    void enqueue(const T &value)
+    {
+        enqueue(T(value));
+    }
+
+    /**
+     * @brief Enqueue value (moving value).
+     *
+     * @param[in,out] value: Value.
+     */
+    void enqueue(T &&value)
+    {
+        if (num_items == capacity)
+        {
+            reserve((capacity > 0) ? (capacity * 2) : DPQUEUE_CAPACITY_MIN);
+        }
+
+        sift_up(num_items, std::move(value));
+
+        num_items++;
+    }
+
+    /**
+     * @brief Enqueue value, constructing it from arguments.
+     *
+     * Values are moved around the heap array as they sift, so the value is
+     * constructed once here and then moved into it's slot.
+     *
+     * @param[in] args: Arguments for value's constructor.
+     */
+    template <typename... Args>
+    void emplace(Args &&... args)
+    {
+        enqueue(T(std::forward<Args>(args)...));
+    }
+
+    /**
+     * @brief Dequeue value.
+     *
+     * @retval Value with highest priority (smallest value).
+     */
+    T dequeue()
+    {
+        assert(num_items > 0);
+
+        T value(std::move(p_items[0]));
+
+        num_items--;
+
+        if (num_items > 0)
+        {
+            sift_down(0, std::move(p_items[num_items]));
+        }
+
+        return value;
+    }
+
+    /**
+     * @brief Dequeue value if queue is not empty.
+     *
+     * @param[out] value: Value with highest priority (smallest value).
+     *
+     * @retval  true if value dequeued
+     * @retval false if queue is empty
+     */
+    bool try_dequeue(T &value)
+    {
+        if (num_items == 0)
+        {
+            return false;
+        }
+
+        value = dequeue();
+
+        return true;
+    }
+
+    /**
+     * @brief Peek value with highest priority.
+     *
+     * @retval Reference to value with highest priority (smallest value).
+     */
+    const T &peek() const
+    {
+        assert(num_items > 0);
+
+        return p_items[0];
+    }
+
+    /**
+     * @brief Is queue empty?
+     *
+     * @retval  true if queue is empty
+     * @retval false if queue is not empty
+     */
+    bool is_empty() const
+    {
+        return (num_items == 0) ? true : false;
+    }
+
+    /**
+     * @brief Get number of items in queue.
+     *
+     * @retval Number of items.
+     */
+    int size() const
+    {
+        return num_items;
+    }
+
+    /**
+     * @brief Make sure that at least a specific number of items can be held
+     *        without reallocating.
+     *
+     * @param[in] count: Number of items.
+     */
+    void reserve(int count)
+    {
+        T *p_items_new;
+
+        int ii;
+
+        if (count <= capacity)
+        {
+            return;
+        }
+
+        p_items_new = items_create(count);
+
+        for (ii = 0; ii < num_items; ii++)
+        {
+            p_items_new[ii] = std::move(p_items[ii]);
+        }
+
+        items_delete(p_items, capacity);
+
+        p_items = p_items_new;
+
+        capacity = count;
+    }
+
+    /**
+     * @brief Verify heap by checking that no item is smaller than it's parent.
+     *
+     * @retval  true if heap is correct
+     * @retval false if heap is incorrect
+     */
+    bool verify() const
+    {
+        int ii;
+
+        for (ii = 1; ii < num_items; ii++)
+        {
+            if (p_items[ii] < p_items[(ii - 1) / D])
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    T *p_items; ///< pointer to item array (heap order)
+
+private:
+
+    /**
+     * @brief Create (cache line aligned) item array.
+     *
+     * @param[in] count: Number of items.
+     *
+     * @retval Pointer to item array (root item).
+     */
+    static T *items_create(int count)
+    {
+        void *p_memory = NULL;
+
+        T *p_items_new;
+
+        int ii;
+
+        if (posix_memalign(&p_memory, DPQUEUE_CACHE_LINE_SIZE,
+                           sizeof(T) * (ROOT_OFFSET + count)) != 0)
+        {
+            throw std::bad_alloc();
+        }
+
+        p_items_new = static_cast<T *>(p_memory) + ROOT_OFFSET;
+
+        for (ii = 0; ii < count; ii++)
+        {
+            new (&p_items_new[ii]) T();
+        }
+
+        return p_items_new;
+    }
+
+    /**
+     * @brief Delete item array.
+     *
+     * @param[in,out] p_items_old: Pointer to item array (may be NULL).
+     * @param[in]     count:       Number of items.
+     */
+    static void items_delete(T *p_items_old, int count)
+    {
+        int ii;
+
+        if (p_items_old == NULL)
+        {
+            return;
+        }
+
+        for (ii = 0; ii < count; ii++)
+        {
+            p_items_old[ii].~T();
+        }
+
+        free(p_items_old - ROOT_OFFSET);
+    }
+
+    /**
+     * @brief Move value up from hole at specific index to it's place.
+     *
+     * @param[in]     index: Index of hole.
+     * @param[in,out] value: Value.
+     */
+    void sift_up(int index, T &&value)
+    {
+        int parent;
+
+        while (index > 0)
+        {
+            parent = (index - 1) / D;
+
+            if (!(value < p_items[parent]))
+            {
+                break;
+            }
+
+            p_items[index] = std::move(p_items[parent]);
+
+            index = parent;
+        }
+
+        p_items[index] = std::move(value);
+    }
+
+    /**
+     * @brief Move value down from hole at specific index to it's place.
+     *
+     * @param[in]     index: Index of hole.
+     * @param[in,out] value: Value.
+     */
+    void sift_down(int index, T &&value)
+    {
+        int child;
+        int num_children;
+
+        while (true)
+        {
+            child = (D * index) + 1;
+
+            if (child >= num_items)
+            {
+                break;
+            }
+
+            num_children = num_items - child;
+
+            if (num_children > D)
+            {
+                num_children = D;
+            }
+
+            child += dpqueue_min_child<T, D>::find(&p_items[child],
+                                                   num_children);
+
+            if (!(p_items[child] < value))
+            {
+                break;
+            }
+
+            p_items[index] = std::move(p_items[child]);
+
+            index = child;
+        }
+
+        p_items[index] = std::move(value);
+    }
+
+    int num_items; ///< number of items in queue
+    int capacity;  ///< number of items allocated
+};
+
+#endif // #ifndef _DPQUEUE_H_
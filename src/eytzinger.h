@@ -0,0 +1,571 @@
+/**
+ * @file  eytzinger.h
+ *
+ * @brief Read-only sorted array class (Eytzinger layout).
+ */
+
+#ifndef _EYTZINGER_H_
+
+#define _EYTZINGER_H_
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <new>
+#include <type_traits>
+
+#include "btree.h"
+
+#define EYTZINGER_CACHE_LINE_SIZE 64 ///< cache line size in bytes
+#define EYTZINGER_BATCH_SIZE      16 ///< lookups interleaved by find_batch
+
+#define EYTZINGER_FILE_MAGIC   "EYTZNGR" ///< image file magic (8 bytes)
+#define EYTZINGER_FILE_VERSION 1         ///< image file format version
+
+/// image file header structure (one cache line, so values stay aligned)
+struct eytzinger_header {
+    char     magic[8];   ///< EYTZINGER_FILE_MAGIC
+    uint32_t version;    ///< EYTZINGER_FILE_VERSION
+    uint32_t value_size; ///< sizeof(T)
+    uint64_t count;      ///< number of values
+    uint64_t checksum;   ///< FNV-1a hash of values' bytes
+
+    char pad[EYTZINGER_CACHE_LINE_SIZE - 32]; ///< pad to cache line
+};
+
+/**
+ * @brief Read-only sorted array class (Eytzinger layout).
+ *
+ * Immutable snapshot of a set of values (see btree::freeze()), stored as an
+ * implicit, perfectly balanced binary search tree in breadth-first order:
+ * node k's children are nodes 2k & 2k + 1 (k starts at 1). There are no
+ * pointers to chase, the top levels of every search share the same few cache
+ * lines, and a search is a fixed sequence of index computations:
+ *
+ * - the comparison result is added to the index instead of branched on;
+ * - since the 16 (4-byte values) nodes four levels below node k are adjacent,
+ *   their cache line is prefetched while those four levels are descended.
+ *
+ * thaw() turns the snapshot back into a (mutable) btree.
+ *
+ * The layout is position-indexed (no pointers), so save() writes it to a
+ * file as is, behind a header, and map() serves it straight from the file's
+ * pages (mmap; shared between processes through the page cache) without
+ * reading it in: loading is O(1) and only touched pages are ever read. The
+ * image is in native byte order, & T must be trivially copyable to be saved
+ * or mapped.
+ */
+template <typename T>
+class eytzinger
+{
+    /// number of values per cache line (prefetch distance multiplier)
+    static const int BLOCK_SIZE =
+        (EYTZINGER_CACHE_LINE_SIZE / (int)sizeof(T) > 0) ?
+        (EYTZINGER_CACHE_LINE_SIZE / (int)sizeof(T)) : 1;
+
+public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] p_sorted: Pointer to values (sorted).
+     * @param[in] count:    Number of values.
+     */
+    eytzinger(const T *p_sorted, int count)
+    {
+        void *p_memory = NULL;
+
+        int index;
+        int ii;
+
+        assert(count >= 0);
+
+        num_values = count;
+
+        // cache line aligned, so that prefetched blocks are whole lines;
+        // element 0 is unused (1-based indices)
+
+        if (posix_memalign(&p_memory, EYTZINGER_CACHE_LINE_SIZE,
+                           sizeof(T) * (count + 1)) != 0)
+        {
+            throw std::bad_alloc();
+        }
+
+        p_values = static_cast<T *>(p_memory);
+
+        p_mapping = NULL;
+
+        mapping_size = 0;
+
+        new (&p_values[0]) T();
+
+        // in-order walk of implicit tree assigns sorted values
+
+        index = first();
+
+        for (ii = 0; ii < count; ii++)
+        {
+            new (&p_values[index]) T(p_sorted[ii]);
+
+            index = next(index);
+        }
+    }
+
+    /**
+     * @brief Destructor.
+     */
+    ~eytzinger()
+    {
+        int ii;
+
+        if (p_mapping != NULL)
+        {
+            munmap(p_mapping, mapping_size);
+
+            return;
+        }
+
+        for (ii = 0; ii <= num_values; ii++)
+        {
+            p_values[ii].~T();
+        }
+
+        free(p_values);
+    }
+
+    /**
+     * @brief Find first value not less than value.
+     *
+     * @param[in] value: Value.
+     *
+     * @retval NULL if all values are less than value.
+     * @retval Pointer to first value >= value.
+     */
+    const T *lower_bound(const T &value) const
+    {
+        int index = 1;
+
+        while (index <= num_values)
+        {
+            __builtin_prefetch(p_values + (long)index * BLOCK_SIZE);
+
+            index = 2 * index + (p_values[index] < value);
+        }
+
+        // undo right turns taken after last left turn (+ that left turn)
+
+        index >>= __builtin_ffs(~index);
+
+        return (index == 0) ? NULL : &p_values[index];
+    }
+
+    /**
+     * @brief Find value.
+     *
+     * @param[in] value: Value.
+     *
+     * @retval NULL if value not found.
+     * @retval Pointer to value.
+     */
+    const T *find(const T &value) const
+    {
+        const T *p_value = lower_bound(value);
+
+        return ((p_value != NULL) && (*p_value == value)) ? p_value : NULL;
+    }
+
+    /**
+     * @brief Find values for a batch of values.
+     *
+     * Same branchless descent as lower_bound(), for EYTZINGER_BATCH_SIZE
+     * values in lock-step: every round moves each lookup one level down and
+     * prefetches the node it moved to, so one round's cache misses overlap.
+     * All lookups take the same (or one more) number of rounds, so lock-step
+     * wastes next to nothing.
+     *
+     * @param[in]  p_keys:    Pointer to values to find.
+     * @param[in]  count:     Number of values to find.
+     * @param[out] pp_values: Pointer to found values (NULL where not found).
+     */
+    void find_batch(const T *p_keys, int count, const T **pp_values) const
+    {
+        int indices[EYTZINGER_BATCH_SIZE];
+
+        int first;
+        int num_lookups;
+        int num_moved;
+        int index;
+        int ii;
+
+        for (first = 0; first < count; first += EYTZINGER_BATCH_SIZE)
+        {
+            num_lookups = (count - first < EYTZINGER_BATCH_SIZE) ?
+                          (count - first) : EYTZINGER_BATCH_SIZE;
+
+            for (ii = 0; ii < num_lookups; ii++)
+            {
+                indices[ii] = 1;
+            }
+
+            do
+            {
+                num_moved = 0;
+
+                for (ii = 0; ii < num_lookups; ii++)
+                {
+                    index = indices[ii];
+
+                    if (index <= num_values)
+                    {
+                        index = 2 * index +
+                                (p_values[index] < p_keys[first + ii]);
+
+                        __builtin_prefetch(p_values + index);
+
+                        indices[ii] = index;
+
+                        num_moved++;
+                    }
+                }
+            }
+            while (num_moved > 0);
+
+            for (ii = 0; ii < num_lookups; ii++)
+            {
+                index = indices[ii] >> __builtin_ffs(~indices[ii]);
+
+                pp_values[first + ii] =
+                    ((index != 0) && (p_values[index] == p_keys[first + ii])) ?
+                    &p_values[index] : NULL;
+            }
+        }
+    }
+
+    /**
+     * @brief Visit values in [first, last) in ascending order (O(log n + k)).
+     *
+     * @param[in] first: Smallest value to visit.
+     * @param[in] last:  Value past largest value to visit.
+     * @param[in] visit: Visitor, called with each value (const T &).
+     *
+     * @retval Number of values visited.
+     */
+    template <typename Visitor>
+    int for_each_in_range(const T &first, const T &last, Visitor visit) const
+    {
+        const T *p_value = lower_bound(first);
+
+        int index = (p_value == NULL) ? 0 : (int)(p_value - p_values);
+        int count = 0;
+
+        while ((index != 0) && (p_values[index] < last))
+        {
+            visit(p_values[index]);
+
+            count++;
+
+            index = next(index);
+        }
+
+        return count;
+    }
+
+    /**
+     * @brief Get number of values.
+     *
+     * @retval Number of values.
+     */
+    int size() const
+    {
+        return num_values;
+    }
+
+    /**
+     * @brief Build (mutable) binary tree of values.
+     *
+     * @retval Pointer to new binary tree (to be deleted by caller).
+     */
+    btree<T> *thaw() const
+    {
+        btree<T> *p_btree = new btree<T>;
+
+        T *p_sorted = new T[num_values > 0 ? num_values : 1];
+
+        int index = first();
+        int ii;
+
+        for (ii = 0; ii < num_values; ii++)
+        {
+            p_sorted[ii] = p_values[index];
+
+            index = next(index);
+        }
+
+        p_btree->build(p_sorted, p_sorted + num_values);
+
+        delete [] p_sorted;
+
+        return p_btree;
+    }
+
+    /**
+     * @brief Write image file: header & values (in layout order, including
+     *        unused element 0).
+     *
+     * @param[in] path: File path.
+     *
+     * @retval  true if file written.
+     * @retval false if file could not be written.
+     */
+    bool save(const char *path) const
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "saved values must be trivially copyable");
+
+        eytzinger_header header;
+
+        FILE *p_file;
+
+        bool written;
+
+        memset(&header, 0, sizeof(header));
+
+        memcpy(header.magic, EYTZINGER_FILE_MAGIC, sizeof(header.magic));
+
+        header.version    = EYTZINGER_FILE_VERSION;
+        header.value_size = sizeof(T);
+        header.count      = num_values;
+        header.checksum   = checksum();
+
+        p_file = fopen(path, "wb");
+
+        if (p_file == NULL)
+        {
+            return false;
+        }
+
+        written = (fwrite(&header, sizeof(header), 1, p_file) == 1) &&
+                  (fwrite(p_values, sizeof(T), num_values + 1, p_file) ==
+                   (size_t)num_values + 1);
+
+        return (fclose(p_file) == 0) && written;
+    }
+
+    /**
+     * @brief Map image file written by save() (read-only; header is checked,
+     *        values are not read, see verify_checksum()).
+     *
+     * @param[in] path: File path.
+     *
+     * @retval NULL if file could not be mapped or is not a matching image.
+     * @retval Pointer to new snapshot (to be deleted by caller; unmaps file).
+     */
+    static eytzinger<T> *map(const char *path)
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "mapped values must be trivially copyable");
+
+        const eytzinger_header *p_header;
+        eytzinger<T>           *p_eytzinger;
+
+        struct stat file_stat;
+
+        void *p_mapping;
+
+        int fd = open(path, O_RDONLY);
+
+        if (fd < 0)
+        {
+            return NULL;
+        }
+
+        if ((fstat(fd, &file_stat) != 0) ||
+            ((size_t)file_stat.st_size < sizeof(eytzinger_header) + sizeof(T)))
+        {
+            close(fd);
+
+            return NULL;
+        }
+
+        p_mapping = mmap(NULL, file_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+        close(fd); // mapping keeps file open
+
+        if (p_mapping == MAP_FAILED)
+        {
+            return NULL;
+        }
+
+        p_header = static_cast<const eytzinger_header *>(p_mapping);
+
+        if ((memcmp(p_header->magic, EYTZINGER_FILE_MAGIC,
+                    sizeof(p_header->magic)) != 0) ||
+            (p_header->version != EYTZINGER_FILE_VERSION) ||
+            (p_header->value_size != sizeof(T)) ||
+            (p_header->count > (uint64_t)INT32_MAX) ||
+            ((size_t)file_stat.st_size !=
+             sizeof(eytzinger_header) + sizeof(T) * (p_header->count + 1)))
+        {
+            munmap(p_mapping, file_stat.st_size);
+
+            return NULL;
+        }
+
+        p_eytzinger = new eytzinger<T>;
+
+        p_eytzinger->p_values = reinterpret_cast<T *>(
+            static_cast<char *>(p_mapping) + sizeof(eytzinger_header));
+
+        p_eytzinger->num_values = (int)p_header->count;
+
+        p_eytzinger->p_mapping = p_mapping;
+
+        p_eytzinger->mapping_size = file_stat.st_size;
+
+        return p_eytzinger;
+    }
+
+    /**
+     * @brief Check that mapped values match header's checksum (reads all of
+     *        them).
+     *
+     * @retval  true if values are intact (or snapshot is not mapped).
+     * @retval false if values are corrupt.
+     */
+    bool verify_checksum() const
+    {
+        if (p_mapping == NULL)
+        {
+            return true;
+        }
+
+        return checksum() ==
+               static_cast<const eytzinger_header *>(p_mapping)->checksum;
+    }
+
+    /**
+     * @brief Verify layout by walking implicit tree in-order and checking that
+     *        no value is smaller than it's predecessor.
+     *
+     * @retval  true if layout is correct
+     * @retval false if layout is incorrect
+     */
+    bool verify() const
+    {
+        int index = first();
+        int index_prev;
+        int ii;
+
+        for (ii = 1; ii < num_values; ii++)
+        {
+            index_prev = index;
+
+            index = next(index);
+
+            if (p_values[index] < p_values[index_prev])
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+private:
+
+    /**
+     * @brief Constructor (empty, for map()).
+     */
+    eytzinger()
+    {
+        p_values = NULL;
+
+        num_values = 0;
+
+        p_mapping = NULL;
+
+        mapping_size = 0;
+    }
+
+    /**
+     * @brief Compute FNV-1a hash of values' bytes (elements 1 to n).
+     *
+     * @retval Hash.
+     */
+    uint64_t checksum() const
+    {
+        const unsigned char *p_bytes =
+            reinterpret_cast<const unsigned char *>(p_values + 1);
+
+        uint64_t hash = 14695981039346656037ULL;
+
+        size_t ii;
+
+        for (ii = 0; ii < sizeof(T) * num_values; ii++)
+        {
+            hash = (hash ^ p_bytes[ii]) * 1099511628211ULL;
+        }
+
+        return hash;
+    }
+
+    /**
+     * @brief Get index of in-order first node (left-most).
+     *
+     * @retval Node index.
+     */
+    int first() const
+    {
+        int index = 1;
+
+        while (2 * index <= num_values)
+        {
+            index *= 2;
+        }
+
+        return index;
+    }
+
+    /**
+     * @brief Get index of node's in-order successor.
+     *
+     * @param[in] index: Node index.
+     *
+     * @retval Node index (0 if none).
+     */
+    int next(int index) const
+    {
+        if (2 * index + 1 <= num_values)
+        {
+            // right sub-tree's left-most node
+
+            index = 2 * index + 1;
+
+            while (2 * index <= num_values)
+            {
+                index *= 2;
+            }
+
+            return index;
+        }
+
+        // up past right-child links, then one more (first left-child link)
+
+        return index >> __builtin_ffs(~index);
+    }
+
+    T  *p_values;   ///< pointer to values (1-based, breadth-first order)
+    int num_values; ///< number of values
+
+    void  *p_mapping;    ///< pointer to mapped image file (NULL: heap)
+    size_t mapping_size; ///< size of mapped image file in bytes
+};
+
+#endif // #ifndef _EYTZINGER_H_
@@ -0,0 +1,540 @@
+/**
+ * @file  ipqueue.h
+ *
+ * @brief Indexed priority queue class (binary heap + position map).
+ */
+
+#ifndef _IPQUEUE_H_
+
+#define _IPQUEUE_H_
+
+#include <assert.h>
+#include <stddef.h>
+#include <utility>
+
+#define IPQUEUE_CAPACITY_MIN 16 ///< minimum number of items allocated
+
+#define IPQUEUE_SLOT_BITS       32         ///< handle bits holding slot
+#define IPQUEUE_GENERATION_MASK 0x7fffffff ///< generation wraps at this
+
+/// indexed priority queue item handle (slot in low IPQUEUE_SLOT_BITS bits,
+/// slot's generation in the rest)
+typedef long long ipqueue_handle;
+
+/**
+ * @brief Indexed priority queue class.
+ *
+ * Same enqueue/dequeue/is_empty interface as pqueue, but enqueue returns a
+ * handle that stays valid (and refers to the same item) until that item is
+ * dequeued or erased. Through it, an item's priority can be changed or the
+ * item removed in O(log n), instead of enqueueing a duplicate.
+ *
+ * Values are stored by slot; the binary min-heap holds slots, and a position
+ * map records where each slot currently sits in the heap. Slots of dequeued
+ * / erased items are recycled, but every slot counts it's reuses: a handle
+ * carries the count (generation) it was handed out with, so a stale handle
+ * never matches the item now in it's slot. contains() reports it as gone;
+ * value(), update(), decrease_key(), increase_key() & erase() assert on it.
+ */
+template <typename T>
+class ipqueue
+{
+public:
+
+    /**
+     * @brief Constructor.
+     */
+    ipqueue()
+    {
+        p_values      = NULL;
+        p_heap        = NULL;
+        p_positions   = NULL;
+        p_generations = NULL;
+        p_free        = NULL;
+
+        num_items = 0;
+        num_slots = 0;
+        num_free  = 0;
+        capacity  = 0;
+    }
+
+    /**
+     * @brief Destructor.
+     */
+    ~ipqueue()
+    {
+        delete [] p_values;
+        delete [] p_heap;
+        delete [] p_positions;
+        delete [] p_generations;
+        delete [] p_free;
+    }
+
+    /**
+     * @brief Enqueue value.
+     *
+     * @param[in] value: Value.
+     *
+     * @retval Handle to enqueued item.
+     */
+    ipqueue_handle enqueue(const T &value)
+    {
+        int slot = slot_create();
+
+        p_values[slot] = value;
+
+        heap_insert(slot);
+
+        return handle_get(slot);
+    }
+
+    /**
+     * @brief Enqueue value (moving value).
+     *
+     * @param[in,out] value: Value.
+     *
+     * @retval Handle to enqueued item.
+     */
+    ipqueue_handle enqueue(T &&value)
+    {
+        int slot = slot_create();
+
+        p_values[slot] = std::move(value);
+
+        heap_insert(slot);
+
+        return handle_get(slot);
+    }
+
+    /**
+     * @brief Dequeue value.
+     *
+     * @retval Value with highest priority (smallest value).
+     */
+    T dequeue()
+    {
+        int slot;
+
+        assert(num_items > 0);
+
+        slot = p_heap[0];
+
+        T value(std::move(p_values[slot]));
+
+        slot_erase(slot);
+
+        return value;
+    }
+
+    /**
+     * @brief Dequeue value if queue is not empty.
+     *
+     * @param[out] value: Value with highest priority (smallest value).
+     *
+     * @retval  true if value dequeued
+     * @retval false if queue is empty
+     */
+    bool try_dequeue(T &value)
+    {
+        if (num_items == 0)
+        {
+            return false;
+        }
+
+        value = dequeue();
+
+        return true;
+    }
+
+    /**
+     * @brief Get handle of item with highest priority.
+     *
+     * @retval Handle.
+     */
+    ipqueue_handle peek_handle() const
+    {
+        assert(num_items > 0);
+
+        return handle_get(p_heap[0]);
+    }
+
+    /**
+     * @brief Get value of item.
+     *
+     * @param[in] handle: Handle.
+     *
+     * @retval Reference to value.
+     */
+    const T &value(ipqueue_handle handle) const
+    {
+        assert(contains(handle));
+
+        return p_values[slot_get(handle)];
+    }
+
+    /**
+     * @brief Is item still in queue?
+     *
+     * @param[in] handle: Handle.
+     *
+     * @retval  true if item is in queue
+     * @retval false if item has been dequeued / erased (even if it's slot
+     *               holds another item now)
+     */
+    bool contains(ipqueue_handle handle) const
+    {
+        int slot = slot_get(handle);
+
+        return (handle >= 0) && (slot < num_slots) &&
+               (p_positions[slot] >= 0) && (handle_get(slot) == handle);
+    }
+
+    /**
+     * @brief Lower item's value (raise it's priority).
+     *
+     * @param[in] handle: Handle.
+     * @param[in] value:  New value (not greater than current value).
+     */
+    void decrease_key(ipqueue_handle handle, const T &value)
+    {
+        int slot = slot_get(handle);
+
+        assert(contains(handle));
+        assert(!(p_values[slot] < value));
+
+        p_values[slot] = value;
+
+        sift_up(p_positions[slot]);
+    }
+
+    /**
+     * @brief Raise item's value (lower it's priority).
+     *
+     * @param[in] handle: Handle.
+     * @param[in] value:  New value (not smaller than current value).
+     */
+    void increase_key(ipqueue_handle handle, const T &value)
+    {
+        int slot = slot_get(handle);
+
+        assert(contains(handle));
+        assert(!(value < p_values[slot]));
+
+        p_values[slot] = value;
+
+        sift_down(p_positions[slot]);
+    }
+
+    /**
+     * @brief Change item's value (either way).
+     *
+     * @param[in] handle: Handle.
+     * @param[in] value:  New value.
+     */
+    void update(ipqueue_handle handle, const T &value)
+    {
+        assert(contains(handle));
+
+        if (value < p_values[slot_get(handle)])
+        {
+            decrease_key(handle, value);
+        }
+        else
+        {
+            increase_key(handle, value);
+        }
+    }
+
+    /**
+     * @brief Remove item from queue.
+     *
+     * @param[in] handle: Handle (stale afterwards).
+     */
+    void erase(ipqueue_handle handle)
+    {
+        assert(contains(handle));
+
+        slot_erase(slot_get(handle));
+    }
+
+    /**
+     * @brief Is queue empty?
+     *
+     * @retval  true if queue is empty
+     * @retval false if queue is not empty
+     */
+    bool is_empty() const
+    {
+        return (num_items == 0) ? true : false;
+    }
+
+    /**
+     * @brief Get number of items in queue.
+     *
+     * @retval Number of items.
+     */
+    int size() const
+    {
+        return num_items;
+    }
+
+    /**
+     * @brief Verify heap & position map.
+     *
+     * @retval  true if queue is correct
+     * @retval false if queue is incorrect
+     */
+    bool verify() const
+    {
+        int ii;
+
+        for (ii = 0; ii < num_items; ii++)
+        {
+            if (p_positions[p_heap[ii]] != ii)
+            {
+                return false;
+            }
+
+            if ((ii > 0) &&
+                (p_values[p_heap[ii]] < p_values[p_heap[(ii - 1) / 2]]))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+private:
+
+    /**
+     * @brief Get handle of item in slot.
+     *
+     * @param[in] slot: Slot.
+     *
+     * @retval Handle.
+     */
+    ipqueue_handle handle_get(int slot) const
+    {
+        return ((ipqueue_handle)p_generations[slot] << IPQUEUE_SLOT_BITS) |
+               slot;
+    }
+
+    /**
+     * @brief Get slot from handle.
+     *
+     * @param[in] handle: Handle.
+     *
+     * @retval Slot.
+     */
+    static int slot_get(ipqueue_handle handle)
+    {
+        return (int)(handle & ((1LL << IPQUEUE_SLOT_BITS) - 1));
+    }
+
+    /**
+     * @brief Get unused slot (recycled if possible).
+     *
+     * @retval Slot.
+     */
+    int slot_create()
+    {
+        if (num_free > 0)
+        {
+            return p_free[--num_free];
+        }
+
+        if (num_slots == capacity)
+        {
+            grow((capacity > 0) ? (capacity * 2) : IPQUEUE_CAPACITY_MIN);
+        }
+
+        p_generations[num_slots] = 0;
+
+        return num_slots++;
+    }
+
+    /**
+     * @brief Remove item in slot from queue, & free slot.
+     *
+     * @param[in] slot: Slot.
+     */
+    void slot_erase(int slot)
+    {
+        int position = p_positions[slot];
+
+        num_items--;
+
+        if (position != num_items)
+        {
+            // fill hole with last item, which may have to move either way
+
+            heap_set(position, p_heap[num_items]);
+
+            sift_up(position);
+            sift_down(p_positions[p_heap[position]]);
+        }
+
+        p_positions[slot] = -1;
+
+        // outstanding handles to slot go stale
+
+        p_generations[slot] = (p_generations[slot] + 1) &
+                              IPQUEUE_GENERATION_MASK;
+
+        p_free[num_free++] = slot;
+    }
+
+    /**
+     * @brief Grow arrays.
+     *
+     * @param[in] count: New number of items allocated.
+     */
+    void grow(int count)
+    {
+        T   *p_values_new      = new T[count];
+        int *p_heap_new        = new int[count];
+        int *p_positions_new   = new int[count];
+        int *p_generations_new = new int[count];
+        int *p_free_new        = new int[count];
+
+        int ii;
+
+        for (ii = 0; ii < num_slots; ii++)
+        {
+            p_values_new[ii]      = std::move(p_values[ii]);
+            p_positions_new[ii]   = p_positions[ii];
+            p_generations_new[ii] = p_generations[ii];
+        }
+
+        for (ii = 0; ii < num_items; ii++)
+        {
+            p_heap_new[ii] = p_heap[ii];
+        }
+
+        for (ii = 0; ii < num_free; ii++)
+        {
+            p_free_new[ii] = p_free[ii];
+        }
+
+        delete [] p_values;
+        delete [] p_heap;
+        delete [] p_positions;
+        delete [] p_generations;
+        delete [] p_free;
+
+        p_values      = p_values_new;
+        p_heap        = p_heap_new;
+        p_positions   = p_positions_new;
+        p_generations = p_generations_new;
+        p_free        = p_free_new;
+
+        capacity = count;
+    }
+
+    /**
+     * @brief Put slot at heap position & record position.
+     *
+     * @param[in] position: Heap position.
+     * @param[in] slot:     Slot.
+     */
+    void heap_set(int position, int slot)
+    {
+        p_heap[position] = slot;
+
+        p_positions[slot] = position;
+    }
+
+    /**
+     * @brief Insert slot (value already set) into heap.
+     *
+     * @param[in] slot: Slot.
+     */
+    void heap_insert(int slot)
+    {
+        heap_set(num_items, slot);
+
+        num_items++;
+
+        sift_up(num_items - 1);
+    }
+
+    /**
+     * @brief Move item at heap position up to it's place.
+     *
+     * @param[in] position: Heap position.
+     */
+    void sift_up(int position)
+    {
+        int slot = p_heap[position];
+        int parent;
+
+        while (position > 0)
+        {
+            parent = (position - 1) / 2;
+
+            if (!(p_values[slot] < p_values[p_heap[parent]]))
+            {
+                break;
+            }
+
+            heap_set(position, p_heap[parent]);
+
+            position = parent;
+        }
+
+        heap_set(position, slot);
+    }
+
+    /**
+     * @brief Move item at heap position down to it's place.
+     *
+     * @param[in] position: Heap position.
+     */
+    void sift_down(int position)
+    {
+        int slot = p_heap[position];
+        int child;
+
+        while (true)
+        {
+            child = (2 * position) + 1;
+
+            if (child >= num_items)
+            {
+                break;
+            }
+
+            if ((child + 1 < num_items) &&
+                (p_values[p_heap[child + 1]] < p_values[p_heap[child]]))
+            {
+                child++;
+            }
+
+            if (!(p_values[p_heap[child]] < p_values[slot]))
+            {
+                break;
+            }
+
+            heap_set(position, p_heap[child]);
+
+            position = child;
+        }
+
+        heap_set(position, slot);
+    }
+
+    T   *p_values;      ///< pointer to value array (indexed by slot)
+    int *p_heap;        ///< pointer to heap array (slots, in heap order)
+    int *p_positions;   ///< pointer to position array (heap position by
+                        ///< slot, -1 if slot is free)
+    int *p_generations; ///< pointer to generation array (reuses by slot)
+    int *p_free;        ///< pointer to free slot array
+
+    int num_items; ///< number of items in queue
+    int num_slots; ///< number of slots ever handed out
+    int num_free;  ///< number of free slots
+    int capacity;  ///< number of items allocated
+};
+
+#endif // #ifndef _IPQUEUE_H_
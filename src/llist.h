@@ -9,12 +9,33 @@
 #define _LLIST_H_
 
 #include <assert.h>
+#include <stddef.h>
+#include <iterator>
+#include <new>
+#include <utility>
+
+#include "pool.h"
 
 /// linked list node structure
 template <typename T>
 struct llist_node {
     T              value;  ///< node value
     llist_node<T> *p_next; ///< pointer to next node
+
+    /// constructor (value-initialised value, e.g. for caller-owned nodes)
+    llist_node() : value(), p_next(NULL) {}
+
+    /**
+     * @brief Constructor, constructing value in place.
+     *
+     * @param[in] p_next: Pointer to next node.
+     * @param[in] args:   Arguments for value's constructor.
+     */
+    template <typename... Args>
+    explicit llist_node(llist_node<T> *p_next, Args &&... args) :
+        value(std::forward<Args>(args)...), p_next(p_next)
+    {
+    }
 };
 
 /// linked list class
@@ -23,6 +44,70 @@ class llist
 {
 public:
 
+    /// forward iterator (wraps pointer to node, i.e. a position in list)
+    class iterator
+    {
+    public:
+
+        typedef std::forward_iterator_tag iterator_category; ///< category
+        typedef T                         value_type;        ///< value type
+        typedef ptrdiff_t                 difference_type;   ///< difference
+        typedef T                        *pointer;           ///< pointer
+        typedef T                        &reference;         ///< reference
+
+        /**
+         * @brief Constructor.
+         *
+         * @param[in] p_node: Pointer to node structure (NULL for end).
+         */
+        explicit iterator(llist_node<T> *p_node = NULL) : p_node(p_node) {}
+
+        /**
+         * @brief Get node at iterator's position.
+         *
+         * @retval Pointer to node structure (for use with insert_after() &
+         *         erase_after()).
+         */
+        llist_node<T> *node() const { return p_node; }
+
+        T &operator*() const { return p_node->value; }  ///< dereference
+        T *operator->() const { return &p_node->value; } ///< member access
+
+        /// pre-increment
+        iterator &operator++()
+        {
+            p_node = p_node->p_next;
+
+            return *this;
+        }
+
+        /// post-increment
+        iterator operator++(int)
+        {
+            iterator temp = *this;
+
+            p_node = p_node->p_next;
+
+            return temp;
+        }
+
+        /// equality
+        bool operator==(const iterator &other) const
+        {
+            return p_node == other.p_node;
+        }
+
+        /// inequality
+        bool operator!=(const iterator &other) const
+        {
+            return p_node != other.p_node;
+        }
+
+    private:
+
+        llist_node<T> *p_node; ///< pointer to node structure
+    };
+
     /**
      * @brief Constructor.
      */
@@ -31,6 +116,10 @@ public:
         p_head = NULL;
         p_tail = NULL;
 
+        p_tail_prev = NULL;
+
+        tail_prev_known = true;
+
         num_nodes = 0;
     }
 
@@ -64,11 +153,32 @@ public:
      *
      * @param[in] value: Value.
      */
-    void add_head(T value)
+    void add_head(const T &value)
+    {
+        emplace_head(value);
+    }
+
+    /**
+     * @brief Add node with associated value to head of list (moving value).
+     *
+     * @param[in,out] value: Value.
+     */
+    void add_head(T &&value)
+    {
+        emplace_head(std::move(value));
+    }
+
+    /**
+     * @brief Add node to head of list, constructing it's value in place.
+     *
+     * @param[in] args: Arguments for value's constructor.
+     */
+    template <typename... Args>
+    void emplace_head(Args &&... args)
     {
         llist_node<T> *p_node = NULL;
 
-        p_node = node_create(value);
+        p_node = node_create(std::forward<Args>(args)...);
 
         p_node->p_next = p_head;
 
@@ -77,6 +187,12 @@ public:
         if (num_nodes == 0)
         {
             p_tail = p_node;
+
+            tail_prev_set(NULL);
+        }
+        else if (num_nodes == 1)
+        {
+            tail_prev_set(p_node);
         }
 
         num_nodes++;
@@ -87,11 +203,32 @@ public:
      *
      * @param[in] value: Value.
      */
-    void add_tail(T value)
+    void add_tail(const T &value)
+    {
+        emplace_tail(value);
+    }
+
+    /**
+     * @brief Add node with associated value to tail of list (moving value).
+     *
+     * @param[in,out] value: Value.
+     */
+    void add_tail(T &&value)
+    {
+        emplace_tail(std::move(value));
+    }
+
+    /**
+     * @brief Add node to tail of list, constructing it's value in place.
+     *
+     * @param[in] args: Arguments for value's constructor.
+     */
+    template <typename... Args>
+    void emplace_tail(Args &&... args)
     {
         llist_node<T> *p_node = NULL;
 
-        p_node = node_create(value);
+        p_node = node_create(std::forward<Args>(args)...);
 
         if (num_nodes == 0)
         {
@@ -102,133 +239,132 @@ public:
             p_tail->p_next = p_node;
         }
 
+        tail_prev_set(p_tail);
+
         p_tail = p_node;
 
         num_nodes++;
     }
 
     /**
-     * @brief Delete node at head of list.
+     * @brief Move value out of head node & delete node.
+     *
+     * @param[out] value: Value at head of list.
+     *
+     * @retval  true if value popped
+     * @retval false if list is empty
      */
-    void delete_head()
+    bool pop_head(T &value)
     {
-        if (num_nodes)
+        if (num_nodes == 0)
         {
-            llist_node<T> *p_temp;
-
-            p_temp = p_head;
+            return false;
+        }
 
-            p_head = p_head->p_next;
+        value = std::move(p_head->value);
 
-            node_delete(p_temp);
+        erase_after(NULL);
 
-            num_nodes--;
+        return true;
+    }
 
-            if (num_nodes == 0)
-            {
-                p_tail = NULL;
-            }
+    /**
+     * @brief Delete node at head of list.
+     */
+    void delete_head()
+    {
+        if (num_nodes)
+        {
+            erase_after(NULL);
         }
     }
 
     /**
      * @brief Delete node at tail of list.
+     *
+     * O(1) while the tail's predecessor is known, i.e. after any add or
+     * insert that created the tail or it's predecessor. Deleting the tail
+     * makes it's predecessor the tail, whose own predecessor is unknown (no
+     * back links), so a second delete_tail() in a row walks the list, unless
+     * the caller supplies the predecessor (see delete_tail(p_prev)).
      */
     void delete_tail()
     {
         llist_node<T> *p_prev = NULL;
         llist_node<T> *p_next;
 
-        p_next = p_head;
-
-        while (p_next != p_tail)
+        if (num_nodes == 0)
         {
-            p_prev = p_next;
-            p_next = p_next->p_next;
+            return;
         }
 
-        p_tail = p_prev;
-
-        if (p_tail != NULL)
+        if (tail_prev_known)
         {
-            p_tail->p_next = NULL;
+            erase_after(p_tail_prev);
         }
-
-        if (p_next != NULL)
+        else
         {
-            node_delete(p_next);
+            p_next = p_head;
 
-            num_nodes--;
-        }
+            while (p_next != p_tail)
+            {
+                p_prev = p_next;
+                p_next = p_next->p_next;
+            }
 
-        if (num_nodes == 0)
-        {
-            p_head = NULL;
+            erase_after(p_prev);
         }
     }
 
+    /**
+     * @brief Delete node at tail of list in O(1), given it's predecessor.
+     *
+     * @param[in] p_prev: Pointer to tail's predecessor node (NULL if tail is
+     *                    head of list).
+     */
+    void delete_tail(llist_node<T> *p_prev)
+    {
+        assert(num_nodes > 0);
+        assert(((p_prev == NULL) ? p_head : p_prev->p_next) == p_tail);
+
+        erase_after(p_prev);
+    }
+
     /**
      * @brief Remove node with associated value from list.
      *
      * @param[in] value: Value.
      */
-    void remove(T value)
+    void remove(const T &value)
     {
         llist_node<T> *p_node;
+        llist_node<T> *p_prev;
 
-        p_node = node_find(value);
+        p_node = find_with_prev(value, &p_prev);
 
         if (p_node != NULL)
         {
-            llist_node<T> *p_prev = NULL;
-            llist_node<T> *p_next;
-
-            p_next = p_head;
-
-            while (p_next != p_node)
-            {
-                p_prev = p_next;
-                p_next = p_next->p_next;
-            }
-
-            if (p_prev != NULL)
-            {
-                p_prev->p_next = p_node->p_next;
-            }
-            else
-            {
-                p_head = p_node->p_next;
-            }
-
-            if (p_node == p_tail)
-            {
-                p_tail = p_prev;
-            }
-
-            node_delete(p_node);
-
-            num_nodes--;
+            erase_after(p_prev);
         }
     }
 
     /**
      * @brief Add node with associated value before specific node.
      *
+     * Has to walk to the node's predecessor; callers that already hold it
+     * should use insert_after() instead (O(1)).
+     *
      * @param[in] p_node: Pointer to node structure before which new node is to
      *                    be added.
      * @param[in] value:  Value.
      */
-    void add_before(llist_node<T> *p_node, T value)
+    void add_before(llist_node<T> *p_node, const T &value)
     {
-        llist_node<T> *p_node_new;
-
         llist_node<T> *p_prev = NULL;
         llist_node<T> *p_next;
 
         assert(p_node != NULL);
 
-        p_node_new = node_create(value);
-
         p_next = p_head;
 
         while (p_next != p_node)
@@ -237,7 +373,56 @@ public:
             p_next = p_next->p_next;
         }
 
-        if (p_prev == NULL)
+        insert_after(p_prev, value);
+    }
+
+    /**
+     * @brief Add node with associated value after specific node in O(1).
+     *
+     * @param[in] p_node: Pointer to node structure after which new node is to
+     *                    be added (NULL to add at head of list).
+     * @param[in] value:  Value.
+     *
+     * @retval Pointer to new node structure.
+     */
+    llist_node<T> *insert_after(llist_node<T> *p_node, const T &value)
+    {
+        return emplace_after(p_node, value);
+    }
+
+    /**
+     * @brief Add node with associated value after specific node in O(1)
+     *        (moving value).
+     *
+     * @param[in]     p_node: Pointer to node structure after which new node is
+     *                        to be added (NULL to add at head of list).
+     * @param[in,out] value:  Value.
+     *
+     * @retval Pointer to new node structure.
+     */
+    llist_node<T> *insert_after(llist_node<T> *p_node, T &&value)
+    {
+        return emplace_after(p_node, std::move(value));
+    }
+
+    /**
+     * @brief Add node after specific node in O(1), constructing it's value in
+     *        place.
+     *
+     * @param[in] p_node: Pointer to node structure after which new node is to
+     *                    be added (NULL to add at head of list).
+     * @param[in] args:   Arguments for value's constructor.
+     *
+     * @retval Pointer to new node structure.
+     */
+    template <typename... Args>
+    llist_node<T> *emplace_after(llist_node<T> *p_node, Args &&... args)
+    {
+        llist_node<T> *p_node_new;
+
+        p_node_new = node_create(std::forward<Args>(args)...);
+
+        if (p_node == NULL)
         {
             p_node_new->p_next = p_head;
 
@@ -245,88 +430,200 @@ public:
         }
         else
         {
-            p_prev->p_next = p_node_new;
+            p_node_new->p_next = p_node->p_next;
+
+            p_node->p_next = p_node_new;
+        }
+
+        if (p_node == p_tail)
+        {
+            tail_prev_set(p_node);
 
-            p_node_new->p_next = p_node;
+            p_tail = p_node_new;
+        }
+        else if (p_node_new->p_next == p_tail)
+        {
+            tail_prev_set(p_node_new);
         }
 
         num_nodes++;
+
+        return p_node_new;
     }
 
-    llist_node<T> *p_head; ///< pointer to head node
+    /**
+     * @brief Delete node after specific node in O(1).
+     *
+     * @param[in] p_node: Pointer to node structure after which node is to be
+     *                    deleted (NULL to delete head of list).
+     */
+    void erase_after(llist_node<T> *p_node)
+    {
+        llist_node<T> *p_temp;
 
-private:
+        if (p_node == NULL)
+        {
+            p_temp = p_head;
+
+            assert(p_temp != NULL);
+
+            p_head = p_temp->p_next;
+        }
+        else
+        {
+            p_temp = p_node->p_next;
+
+            assert(p_temp != NULL);
+
+            p_node->p_next = p_temp->p_next;
+        }
+
+        if (p_temp == p_tail)
+        {
+            // node is new tail; it's predecessor is only known at head
+
+            p_tail = p_node;
+
+            p_tail_prev = NULL;
+
+            tail_prev_known = (p_node == NULL) || (p_node == p_head);
+        }
+        else if (tail_prev_known && (p_temp == p_tail_prev))
+        {
+            tail_prev_set(p_node);
+        }
+
+        node_delete(p_temp);
+
+        num_nodes--;
+    }
 
     /**
-     * @brief Create node with associated value.
+     * @brief Find first node with associated value, along with it's
+     *        predecessor (single scan).
      *
-     * @param[in] value: Value.
+     * @param[in]  value:   Value.
+     * @param[out] pp_prev: Pointer to pointer to predecessor node (set to NULL
+     *                      if node is head of list).
      *
-     * @retval Pointer to new node structure.
+     * @retval NULL if node with associated value not found.
+     * @retval Pointer to node with associated value.
      */
-    llist_node<T> *node_create(T value)
+    llist_node<T> *find_with_prev(const T &value, llist_node<T> **pp_prev)
     {
-        llist_node<T> *p_node = NULL;
+        llist_node<T> *p_node;
 
-        p_node = new llist_node<T>;
+        *pp_prev = NULL;
 
-        p_node->value = value;
+        p_node = p_head;
+
+        while ((p_node != NULL) && !(p_node->value == value))
+        {
+            *pp_prev = p_node;
 
-        p_node->p_next = NULL;
+            p_node = p_node->p_next;
+        }
 
         return p_node;
     }
 
     /**
-     * @brief Delete node.
+     * @brief Get iterator to head of list.
      *
-     * @param[in,out] p_node: Pointer to node structure.
+     * @retval Iterator.
      */
-    void node_delete(llist_node<T> *p_node)
+    iterator begin()
     {
-        delete p_node;
+        return iterator(p_head);
     }
 
     /**
-     * @brief Find first node with associated value.
+     * @brief Get iterator past tail of list.
      *
-     * @param[in] value: Value.
+     * @retval Iterator.
+     */
+    iterator end()
+    {
+        return iterator(NULL);
+    }
+
+    /**
+     * @brief Make sure that at least a specific number of nodes can be added
+     *        without allocating memory from heap.
      *
-     * @retval Pointer to node structure.
+     * @param[in] count: Number of nodes.
      */
-    llist_node<T> *node_find(T value)
+    void reserve(int count)
     {
-        llist_node<T> *p_node;
+        node_pool.reserve(count);
+    }
 
-        bool found = false;
+    /**
+     * @brief Get number of nodes list's pool holds (in use or free); it only
+     *        changes when nodes are allocated from heap.
+     *
+     * @retval Number of nodes.
+     */
+    int capacity() const
+    {
+        return node_pool.size();
+    }
 
-        p_node = p_head;
+    llist_node<T> *p_head; ///< pointer to head node
 
-        while ((p_node != NULL) && (found == false))
-        {
-            if (p_node->value == value)
-            {
-                found = true;
-            }
-            else
-            {
-                p_node = p_node->p_next;
-            }
-        }
+private:
 
-        if (found)
-        {
-            return p_node;
-        }
-        else
-        {
-            return NULL;
-        }
+    /**
+     * @brief Create node, constructing it's value in place.
+     *
+     * @param[in] args: Arguments for value's constructor.
+     *
+     * @retval Pointer to new node structure.
+     */
+    template <typename... Args>
+    llist_node<T> *node_create(Args &&... args)
+    {
+        llist_node<T> *p_node = NULL;
+
+        p_node = new (node_pool.alloc())
+                     llist_node<T>(NULL, std::forward<Args>(args)...);
+
+        return p_node;
     }
 
-    llist_node<T> *p_tail; ///< pointer to tail node
+    /**
+     * @brief Record tail's predecessor.
+     *
+     * @param[in] p_node: Pointer to tail's predecessor node (NULL if tail is
+     *                    head of list).
+     */
+    void tail_prev_set(llist_node<T> *p_node)
+    {
+        p_tail_prev = p_node;
+
+        tail_prev_known = true;
+    }
+
+    /**
+     * @brief Delete node.
+     *
+     * @param[in,out] p_node: Pointer to node structure.
+     */
+    void node_delete(llist_node<T> *p_node)
+    {
+        p_node->~llist_node<T>();
+
+        node_pool.release(p_node);
+    }
+
+    llist_node<T> *p_tail;      ///< pointer to tail node
+    llist_node<T> *p_tail_prev; ///< pointer to tail's predecessor node
+
+    bool tail_prev_known; ///< is p_tail_prev up to date?
 
     int num_nodes; ///< number of nodes in list
+
+    pool< llist_node<T> > node_pool; ///< node pool
 };
 
 #endif // #ifndef _LLIST_H_
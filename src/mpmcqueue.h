@@ -0,0 +1,372 @@
+/**
+ * @file  mpmcqueue.h
+ *
+ * @brief Multi-producer/multi-consumer (lock-free) bounded queue class.
+ */
+
+#ifndef _MPMCQUEUE_H_
+
+#define _MPMCQUEUE_H_
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+#include <utility>
+
+#define MPMCQUEUE_CACHE_LINE_SIZE 64 ///< cache line size in bytes
+
+/// multi-producer/multi-consumer queue cell structure
+template <typename T>
+struct mpmcqueue_cell {
+    std::atomic<size_t> sequence; ///< sequence number
+    T                   value;    ///< cell value
+};
+
+/**
+ * @brief Multi-producer/multi-consumer queue class.
+ *
+ * Bounded ring buffer of power-of-two size (Vyukov's algorithm). Each cell
+ * carries a sequence number that says whether it is ready to be enqueued into
+ * (sequence == position) or dequeued from (sequence == position + 1) on the
+ * current lap, so producers only contend on the enqueue position, consumers
+ * only on the dequeue position, and a claimed cell is then filled or drained
+ * without further synchronisation.
+ */
+template <typename T>
+class mpmcqueue
+{
+public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] capacity: Minimum number of items queue can hold (rounded up
+     *                      to power of two).
+     */
+    explicit mpmcqueue(int capacity)
+    {
+        size_t size = 1;
+        size_t ii;
+
+        assert(capacity > 0);
+
+        while (size < (size_t)capacity)
+        {
+            size <<= 1;
+        }
+
+        p_cells = new mpmcqueue_cell<T>[size];
+
+        for (ii = 0; ii < size; ii++)
+        {
+            p_cells[ii].sequence.store(ii, std::memory_order_relaxed);
+        }
+
+        mask = size - 1;
+
+        enqueue_pos.store(0);
+        dequeue_pos.store(0);
+    }
+
+    /**
+     * @brief Destructor.
+     */
+    ~mpmcqueue()
+    {
+        delete [] p_cells;
+    }
+
+    /**
+     * @brief Enqueue value, waiting while queue is full.
+     *
+     * @param[in] value: Value.
+     */
+    void enqueue(const T &value)
+    {
+        while (try_enqueue(value) == false)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * @brief Enqueue value, waiting while queue is full (moving value).
+     *
+     * @param[in,out] value: Value.
+     */
+    void enqueue(T &&value)
+    {
+        while (try_enqueue(std::move(value)) == false)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * @brief Enqueue value if queue is not full.
+     *
+     * @param[in] value: Value.
+     *
+     * @retval  true if value enqueued
+     * @retval false if queue is full
+     */
+    bool try_enqueue(const T &value)
+    {
+        mpmcqueue_cell<T> *p_cell;
+
+        size_t pos;
+
+        if (enqueue_claim(&pos, 1) == 0)
+        {
+            return false;
+        }
+
+        p_cell = &p_cells[pos & mask];
+
+        p_cell->value = value;
+
+        p_cell->sequence.store(pos + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+     * @brief Enqueue value if queue is not full (moving value).
+     *
+     * @param[in,out] value: Value (only moved from if enqueued).
+     *
+     * @retval  true if value enqueued
+     * @retval false if queue is full
+     */
+    bool try_enqueue(T &&value)
+    {
+        mpmcqueue_cell<T> *p_cell;
+
+        size_t pos;
+
+        if (enqueue_claim(&pos, 1) == 0)
+        {
+            return false;
+        }
+
+        p_cell = &p_cells[pos & mask];
+
+        p_cell->value = std::move(value);
+
+        p_cell->sequence.store(pos + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+     * @brief Enqueue as many values as fit, claiming their cells at once.
+     *
+     * @param[in] p_values: Pointer to values.
+     * @param[in] count:    Number of values.
+     *
+     * @retval Number of values enqueued (from start of p_values).
+     */
+    int try_enqueue_bulk(const T *p_values, int count)
+    {
+        size_t pos;
+
+        int num_claimed;
+        int ii;
+
+        num_claimed = enqueue_claim(&pos, count);
+
+        for (ii = 0; ii < num_claimed; ii++)
+        {
+            mpmcqueue_cell<T> *p_cell = &p_cells[(pos + ii) & mask];
+
+            p_cell->value = p_values[ii];
+
+            p_cell->sequence.store(pos + ii + 1, std::memory_order_release);
+        }
+
+        return num_claimed;
+    }
+
+    /**
+     * @brief Dequeue value, waiting while queue is empty.
+     *
+     * @retval Value at head of queue.
+     */
+    T dequeue()
+    {
+        T value;
+
+        while (try_dequeue(value) == false)
+        {
+            std::this_thread::yield();
+        }
+
+        return value;
+    }
+
+    /**
+     * @brief Dequeue value if queue is not empty.
+     *
+     * @param[out] value: Value at head of queue.
+     *
+     * @retval  true if value dequeued
+     * @retval false if queue is empty
+     */
+    bool try_dequeue(T &value)
+    {
+        return try_dequeue_bulk(&value, 1) == 1;
+    }
+
+    /**
+     * @brief Dequeue as many values as available (up to count), claiming their
+     *        cells at once.
+     *
+     * @param[out] p_values: Pointer to values.
+     * @param[in]  count:    Maximum number of values.
+     *
+     * @retval Number of values dequeued (to start of p_values).
+     */
+    int try_dequeue_bulk(T *p_values, int count)
+    {
+        size_t pos;
+
+        int num_claimed;
+        int ii;
+
+        num_claimed = dequeue_claim(&pos, count);
+
+        for (ii = 0; ii < num_claimed; ii++)
+        {
+            mpmcqueue_cell<T> *p_cell = &p_cells[(pos + ii) & mask];
+
+            p_values[ii] = std::move(p_cell->value);
+
+            p_cell->sequence.store(pos + ii + mask + 1,
+                                   std::memory_order_release);
+        }
+
+        return num_claimed;
+    }
+
+    /**
+     * @brief Is queue empty? (snapshot; may be stale by the time it returns)
+     *
+     * @retval  true if queue is empty
+     * @retval false if queue is not empty
+     */
+    bool is_empty()
+    {
+        return dequeue_pos.load(std::memory_order_acquire) >=
+               enqueue_pos.load(std::memory_order_acquire);
+    }
+
+private:
+
+    /**
+     * @brief Claim run of consecutive cells that are ready on their current
+     *        lap (sequence == position + offset).
+     *
+     * Counts ready cells from the loaded position, then claims them with one
+     * compare-and-swap on the position; retries from the new position if
+     * another thread got there first.
+     *
+     * @param[in,out] position: Shared position (enqueue or dequeue).
+     * @param[in]     offset:   Sequence offset of a ready cell (0 to enqueue,
+     *                          1 to dequeue).
+     * @param[out]    p_pos:    Pointer to first claimed position.
+     * @param[in]     count:    Maximum number of cells.
+     *
+     * @retval Number of cells claimed (0 if queue is full / empty).
+     */
+    int claim(std::atomic<size_t> &position, size_t offset, size_t *p_pos,
+              int count)
+    {
+        size_t pos = position.load(std::memory_order_relaxed);
+
+        int num_ready;
+
+        if (count <= 0)
+        {
+            return 0;
+        }
+
+        while (true)
+        {
+            for (num_ready = 0; num_ready < count; num_ready++)
+            {
+                size_t sequence = p_cells[(pos + num_ready) & mask].sequence
+                                  .load(std::memory_order_acquire);
+
+                if (sequence != pos + num_ready + offset)
+                {
+                    break;
+                }
+            }
+
+            if (num_ready == 0)
+            {
+                size_t sequence = p_cells[pos & mask].sequence
+                                  .load(std::memory_order_acquire);
+
+                if ((intptr_t)(sequence - (pos + offset)) < 0)
+                {
+                    return 0; // cell still on previous lap: full / empty
+                }
+
+                pos = position.load(std::memory_order_relaxed);
+            }
+            else if (position.compare_exchange_weak(pos, pos + num_ready,
+                                                    std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+
+        *p_pos = pos;
+
+        return num_ready;
+    }
+
+    /**
+     * @brief Claim cells to enqueue into.
+     *
+     * @param[out] p_pos: Pointer to first claimed position.
+     * @param[in]  count: Maximum number of cells.
+     *
+     * @retval Number of cells claimed.
+     */
+    int enqueue_claim(size_t *p_pos, int count)
+    {
+        return claim(enqueue_pos, 0, p_pos, count);
+    }
+
+    /**
+     * @brief Claim cells to dequeue from.
+     *
+     * @param[out] p_pos: Pointer to first claimed position.
+     * @param[in]  count: Maximum number of cells.
+     *
+     * @retval Number of cells claimed.
+     */
+    int dequeue_claim(size_t *p_pos, int count)
+    {
+        return claim(dequeue_pos, 1, p_pos, count);
+    }
+
+    mpmcqueue_cell<T> *p_cells; ///< pointer to cell array
+    size_t             mask;    ///< cell array size - 1
+
+    char pad_0[MPMCQUEUE_CACHE_LINE_SIZE]; ///< keep producers' line apart
+
+    std::atomic<size_t> enqueue_pos; ///< next position to enqueue into
+
+    char pad_1[MPMCQUEUE_CACHE_LINE_SIZE]; ///< keep consumers' line apart
+
+    std::atomic<size_t> dequeue_pos; ///< next position to dequeue from
+
+    char pad_2[MPMCQUEUE_CACHE_LINE_SIZE]; ///< keep neighbours apart
+};
+
+#endif // #ifndef _MPMCQUEUE_H_
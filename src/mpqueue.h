@@ -0,0 +1,320 @@
+/**
+ * @file  mpqueue.h
+ *
+ * @brief Concurrent (relaxed) priority queue class (MultiQueue).
+ */
+
+#ifndef _MPQUEUE_H_
+
+#define _MPQUEUE_H_
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "dpqueue.h"
+
+#define MPQUEUE_CACHE_LINE_SIZE     64 ///< cache line size in bytes
+#define MPQUEUE_SHARDS_PER_THREAD    2 ///< default shards per thread (c)
+#define MPQUEUE_DEQUEUE_ATTEMPTS     8 ///< two-choice rounds before full scan
+#define MPQUEUE_ENQUEUE_ATTEMPTS     8 ///< try_lock()s before blocking on lock
+
+/// concurrent priority queue shard structure
+template <typename T>
+struct mpqueue_shard {
+    std::mutex       lock; ///< protects heap
+    dpqueue<T>       heap; ///< shard's heap
+    std::atomic<T>   top;  ///< copy of heap's smallest value (if size > 0)
+    std::atomic<int> size; ///< copy of heap's size
+
+    char pad[MPQUEUE_CACHE_LINE_SIZE]; ///< keep neighbouring shards apart
+};
+
+/**
+ * @brief Concurrent priority queue class.
+ *
+ * MultiQueue: values are spread over c * P independently locked heaps (P =
+ * number of threads). enqueue() inserts into a random shard; dequeue() looks
+ * at the cached smallest values of two random shards (power of two choices)
+ * and dequeues from the better one. No lock is global, so throughput grows
+ * with the number of threads, at the price of relaxed ordering: a dequeued
+ * value is not always the smallest one queued, but it's expected rank among
+ * the queued values is O(c * P). Fewer shards per thread (c) means tighter
+ * ordering; more means less lock contention.
+ *
+ * When both choices keep coming up empty (or locked), dequeue falls back to
+ * scanning all shards, so it only reports an empty queue if every shard was
+ * empty when the scan passed it: without concurrent enqueues, that means
+ * the queue is empty; with them, a value enqueued into a shard the scan had
+ * already passed may still be queued.
+ *
+ * Values are copied into the cached tops with plain atomic loads & stores,
+ * so T must be trivially copyable (e.g. a priority/id pair packed in an
+ * integer).
+ */
+template <typename T>
+class mpqueue
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "concurrent priority queue values must be trivially "
+                  "copyable");
+
+public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] num_threads:       Number of threads using queue (P).
+     * @param[in] shards_per_thread: Number of shards per thread (c).
+     */
+    explicit mpqueue(int num_threads,
+                     int shards_per_thread = MPQUEUE_SHARDS_PER_THREAD)
+    {
+        int ii;
+
+        assert(num_threads > 0);
+        assert(shards_per_thread > 0);
+
+        num_shards = num_threads * shards_per_thread;
+
+        p_shards = new mpqueue_shard<T>[num_shards];
+
+        for (ii = 0; ii < num_shards; ii++)
+        {
+            p_shards[ii].size.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Destructor.
+     */
+    ~mpqueue()
+    {
+        delete [] p_shards;
+    }
+
+    /**
+     * @brief Enqueue value (any thread).
+     *
+     * @param[in] value: Value.
+     */
+    void enqueue(const T &value)
+    {
+        mpqueue_shard<T> *p_shard;
+
+        int ii;
+
+        // random shard that isn't locked (or, after a few tries, any)
+
+        for (ii = 0; ; ii++)
+        {
+            p_shard = &p_shards[shard_index()];
+
+            if (p_shard->lock.try_lock())
+            {
+                break;
+            }
+
+            if (ii == MPQUEUE_ENQUEUE_ATTEMPTS)
+            {
+                p_shard->lock.lock();
+                break;
+            }
+        }
+
+        p_shard->heap.enqueue(value);
+
+        shard_update(p_shard);
+
+        p_shard->lock.unlock();
+    }
+
+    /**
+     * @brief Dequeue value, waiting while queue is empty (any thread).
+     *
+     * @retval Value with (approximately) highest priority.
+     */
+    T dequeue()
+    {
+        T value;
+
+        while (try_dequeue(value) == false)
+        {
+            std::this_thread::yield();
+        }
+
+        return value;
+    }
+
+    /**
+     * @brief Dequeue value if queue is not empty (any thread).
+     *
+     * @param[out] value: Value with (approximately) highest priority.
+     *
+     * @retval  true if value dequeued
+     * @retval false if every shard was found empty (values enqueued
+     *               meanwhile may have been missed)
+     */
+    bool try_dequeue(T &value)
+    {
+        mpqueue_shard<T> *p_shard;
+
+        int first;
+        int ii;
+
+        for (ii = 0; ii < MPQUEUE_DEQUEUE_ATTEMPTS; ii++)
+        {
+            p_shard = shard_choose(&p_shards[shard_index()],
+                                   &p_shards[shard_index()]);
+
+            if ((p_shard != NULL) && p_shard->lock.try_lock())
+            {
+                if (shard_dequeue(p_shard, value))
+                {
+                    return true;
+                }
+            }
+        }
+
+        // full scan, starting at random shard
+
+        first = shard_index();
+
+        for (ii = 0; ii < num_shards; ii++)
+        {
+            p_shard = &p_shards[(first + ii) % num_shards];
+
+            if (p_shard->size.load(std::memory_order_acquire) > 0)
+            {
+                p_shard->lock.lock();
+
+                if (shard_dequeue(p_shard, value))
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Is queue empty? (snapshot; may be stale by the time it returns)
+     *
+     * @retval  true if queue is empty
+     * @retval false if queue is not empty
+     */
+    bool is_empty() const
+    {
+        int ii;
+
+        for (ii = 0; ii < num_shards; ii++)
+        {
+            if (p_shards[ii].size.load(std::memory_order_acquire) > 0)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+private:
+
+    /**
+     * @brief Pick shard with smaller cached top (power of two choices).
+     *
+     * @param[in] p_shard_a: Pointer to first shard.
+     * @param[in] p_shard_b: Pointer to second shard.
+     *
+     * @retval NULL if both shards are empty
+     * @retval Pointer to chosen shard
+     */
+    static mpqueue_shard<T> *shard_choose(mpqueue_shard<T> *p_shard_a,
+                                          mpqueue_shard<T> *p_shard_b)
+    {
+        if (p_shard_a->size.load(std::memory_order_acquire) == 0)
+        {
+            return (p_shard_b->size.load(std::memory_order_acquire) == 0) ?
+                   NULL : p_shard_b;
+        }
+
+        if (p_shard_b->size.load(std::memory_order_acquire) == 0)
+        {
+            return p_shard_a;
+        }
+
+        return (p_shard_b->top.load(std::memory_order_relaxed) <
+                p_shard_a->top.load(std::memory_order_relaxed)) ?
+               p_shard_b : p_shard_a;
+    }
+
+    /**
+     * @brief Dequeue value from locked shard & unlock it.
+     *
+     * @param[in,out] p_shard: Pointer to shard (locked).
+     * @param[out]    value:   Value with highest priority in shard.
+     *
+     * @retval  true if value dequeued
+     * @retval false if shard is empty
+     */
+    static bool shard_dequeue(mpqueue_shard<T> *p_shard, T &value)
+    {
+        bool dequeued = p_shard->heap.try_dequeue(value);
+
+        if (dequeued)
+        {
+            shard_update(p_shard);
+        }
+
+        p_shard->lock.unlock();
+
+        return dequeued;
+    }
+
+    /**
+     * @brief Refresh locked shard's cached top & size.
+     *
+     * @param[in,out] p_shard: Pointer to shard (locked).
+     */
+    static void shard_update(mpqueue_shard<T> *p_shard)
+    {
+        if (p_shard->heap.is_empty() == false)
+        {
+            p_shard->top.store(p_shard->heap.peek(), std::memory_order_relaxed);
+        }
+
+        p_shard->size.store(p_shard->heap.size(), std::memory_order_release);
+    }
+
+    /**
+     * @brief Pick random shard (per-thread xorshift generator).
+     *
+     * @retval Shard index.
+     */
+    int shard_index() const
+    {
+        static thread_local uint32_t state = 0;
+
+        if (state == 0)
+        {
+            state = (uint32_t)(uintptr_t)&state | 1;
+        }
+
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+
+        return (int)(state % (uint32_t)num_shards);
+    }
+
+    mpqueue_shard<T> *p_shards;   ///< pointer to shard array
+    int               num_shards; ///< number of shards (c * P)
+};
+
+#endif // #ifndef _MPQUEUE_H_
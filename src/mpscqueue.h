@@ -0,0 +1,225 @@
+/**
+ * @file  mpscqueue.h
+ *
+ * @brief Multi-producer/single-consumer (lock-free) intrusive queue class.
+ */
+
+#ifndef _MPSCQUEUE_H_
+
+#define _MPSCQUEUE_H_
+
+#include <assert.h>
+#include <stddef.h>
+#include <atomic>
+#include <utility>
+
+#include "llist.h"
+
+#define MPSCQUEUE_CACHE_LINE_SIZE 64 ///< cache line size in bytes
+
+/**
+ * @brief Multi-producer/single-consumer queue class.
+ *
+ * Unbounded intrusive queue of llist_node<T> nodes (Vyukov's algorithm):
+ * a producer links a node in with a single atomic exchange on the head, and
+ * the consumer follows p_next links from the tail with plain (acquire) loads.
+ * A stub node keeps the list non-empty, so neither side ever has to handle an
+ * empty list specially.
+ *
+ * Producers may pass in their own (e.g. preallocated) nodes, in which case
+ * enqueueing is allocation-free; dequeue_node() hands the very same node back
+ * to the consumer. Nodes are only read through p_next's atomic accesses while
+ * queued, so any llist_node<T> will do.
+ */
+template <typename T>
+class mpscqueue
+{
+public:
+
+    /**
+     * @brief Constructor.
+     */
+    mpscqueue()
+    {
+        stub.p_next = NULL;
+
+        head.store(&stub);
+
+        p_tail = &stub;
+    }
+
+    /**
+     * @brief Destructor (not thread-safe).
+     *
+     * Nodes still queued are deleted, so callers that enqueue nodes they did
+     * not allocate with new must drain the queue with dequeue_node() first.
+     */
+    ~mpscqueue()
+    {
+        llist_node<T> *p_node;
+
+        while ((p_node = dequeue_node()) != NULL)
+        {
+            delete p_node;
+        }
+    }
+
+    /**
+     * @brief Enqueue node (any thread).
+     *
+     * @param[in,out] p_node: Pointer to node structure (value already set).
+     */
+    void enqueue(llist_node<T> *p_node)
+    {
+        llist_node<T> *p_prev;
+
+        __atomic_store_n(&p_node->p_next, (llist_node<T> *)NULL,
+                         __ATOMIC_RELAXED);
+
+        p_prev = head.exchange(p_node, std::memory_order_acq_rel);
+
+        // node is now reachable from head, but not yet from tail: consumer
+        // sees queue as (momentarily) shorter until this store lands
+
+        __atomic_store_n(&p_prev->p_next, p_node, __ATOMIC_RELEASE);
+    }
+
+    /**
+     * @brief Enqueue value in newly allocated node (any thread).
+     *
+     * @param[in] value: Value.
+     */
+    void enqueue(const T &value)
+    {
+        enqueue(new llist_node<T>(NULL, value));
+    }
+
+    /**
+     * @brief Enqueue value in newly allocated node (any thread, moving value).
+     *
+     * @param[in,out] value: Value.
+     */
+    void enqueue(T &&value)
+    {
+        enqueue(new llist_node<T>(NULL, std::move(value)));
+    }
+
+    /**
+     * @brief Dequeue node (consumer thread only).
+     *
+     * @retval NULL if queue is empty (or it's only node is still being linked
+     *         in by a producer).
+     * @retval Pointer to dequeued node (now owned by caller).
+     */
+    llist_node<T> *dequeue_node()
+    {
+        llist_node<T> *p_node = p_tail;
+        llist_node<T> *p_next = next(p_node);
+
+        if (p_node == &stub)
+        {
+            if (p_next == NULL)
+            {
+                return NULL;
+            }
+
+            // skip stub
+
+            p_tail = p_next;
+
+            p_node = p_next;
+            p_next = next(p_next);
+        }
+
+        if (p_next != NULL)
+        {
+            p_tail = p_next;
+
+            return p_node;
+        }
+
+        if (p_node != head.load(std::memory_order_acquire))
+        {
+            return NULL; // producer between exchange & link
+        }
+
+        // node is last in queue: re-insert stub behind it, so that it can be
+        // unlinked without leaving the list empty
+
+        enqueue(&stub);
+
+        p_next = next(p_node);
+
+        if (p_next != NULL)
+        {
+            p_tail = p_next;
+
+            return p_node;
+        }
+
+        return NULL;
+    }
+
+    /**
+     * @brief Dequeue value & delete it's node (consumer thread only; nodes
+     *        must have been allocated with new, e.g. by enqueue(value)).
+     *
+     * @param[out] value: Value at head of queue.
+     *
+     * @retval  true if value dequeued
+     * @retval false if queue is empty
+     */
+    bool try_dequeue(T &value)
+    {
+        llist_node<T> *p_node;
+
+        p_node = dequeue_node();
+
+        if (p_node == NULL)
+        {
+            return false;
+        }
+
+        value = std::move(p_node->value);
+
+        delete p_node;
+
+        return true;
+    }
+
+    /**
+     * @brief Is queue empty? (consumer thread only)
+     *
+     * @retval  true if queue is empty
+     * @retval false if queue is not empty
+     */
+    bool is_empty()
+    {
+        return (p_tail == &stub) && (next(&stub) == NULL);
+    }
+
+private:
+
+    /**
+     * @brief Get node's successor.
+     *
+     * @param[in] p_node: Pointer to node structure.
+     *
+     * @retval Pointer to next node.
+     */
+    static llist_node<T> *next(llist_node<T> *p_node)
+    {
+        return __atomic_load_n(&p_node->p_next, __ATOMIC_ACQUIRE);
+    }
+
+    std::atomic<llist_node<T> *> head; ///< last enqueued node (producers)
+
+    char pad_0[MPSCQUEUE_CACHE_LINE_SIZE]; ///< keep consumer's line apart
+
+    llist_node<T> *p_tail; ///< next node to dequeue (consumer)
+    llist_node<T>  stub;   ///< stub node
+
+    char pad_1[MPSCQUEUE_CACHE_LINE_SIZE]; ///< keep neighbours apart
+};
+
+#endif // #ifndef _MPSCQUEUE_H_
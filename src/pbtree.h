@@ -0,0 +1,543 @@
+/**
+ * @file  pbtree.h
+ *
+ * @brief Persistent binary tree class (path copying, shared snapshots).
+ */
+
+#ifndef _PBTREE_H_
+
+#define _PBTREE_H_
+
+#include <assert.h>
+#include <stddef.h>
+#include <atomic>
+#include <utility>
+
+/// persistent binary tree node structure
+template <typename T>
+struct pbtree_node {
+    T                value;   ///< node value
+    pbtree_node<T>  *p_left;  ///< pointer to left child node
+    pbtree_node<T>  *p_right; ///< pointer to right child node
+    std::atomic<int> refs;    ///< number of parent nodes & trees referring
+
+    /**
+     * @brief Constructor, constructing value in place.
+     *
+     * @param[in] p_left:  Pointer to left child node.
+     * @param[in] p_right: Pointer to right child node.
+     * @param[in] refs:    Number of references.
+     * @param[in] args:    Arguments for value's constructor.
+     */
+    template <typename... Args>
+    pbtree_node(pbtree_node<T> *p_left, pbtree_node<T> *p_right, int refs,
+                Args &&... args) :
+        value(std::forward<Args>(args)...), p_left(p_left), p_right(p_right),
+        refs(refs)
+    {
+    }
+};
+
+/**
+ * @brief Persistent binary tree class.
+ *
+ * Same add/find/remove/depth/verify interface as btree, but nodes are shared
+ * between versions of the tree: snapshot() returns a read-only version in
+ * O(1), by just taking another reference to the root node. Nodes are never
+ * modified while shared: add & remove descend from the root and copy every
+ * shared node on their path (the copy refers to the same children, which
+ * are thereby shared too, so the rest of the path gets copied as well), so
+ * they copy O(depth) nodes while any older version shares the path, and none
+ * while no snapshot is around.
+ *
+ * Every node counts the references to it (parent nodes & tree objects);
+ * deleting a version releases it's root, and a node whose count drops to
+ * zero is deleted, releasing it's children in turn (iteratively).
+ *
+ * A tree may only be modified (and snapshot) by one thread at a time, but
+ * snapshots may be read & deleted by other threads meanwhile: reference
+ * counts are atomic, and nodes come straight from the heap (no pool), since
+ * they may be deleted in any thread.
+ */
+template <typename T>
+class pbtree
+{
+public:
+
+    /**
+     * @brief Constructor.
+     */
+    pbtree()
+    {
+        p_root = NULL;
+
+        num_nodes = 0;
+    }
+
+    /**
+     * @brief Copy constructor: new version sharing all of other's nodes.
+     *
+     * @param[in] other: Tree to share nodes with.
+     */
+    pbtree(const pbtree<T> &other)
+    {
+        p_root = other.p_root;
+
+        num_nodes = other.num_nodes;
+
+        node_retain(p_root);
+    }
+
+    /**
+     * @brief Destructor (deletes nodes not shared with other versions).
+     */
+    ~pbtree()
+    {
+        node_release(p_root);
+    }
+
+    /**
+     * @brief Add node with associated value to tree.
+     *
+     * @param[in] value: Value.
+     */
+    void add(const T &value)
+    {
+        add_node(node_create(NULL, NULL, value));
+    }
+
+    /**
+     * @brief Add node with associated value to tree (moving value).
+     *
+     * @param[in,out] value: Value.
+     */
+    void add(T &&value)
+    {
+        add_node(node_create(NULL, NULL, std::move(value)));
+    }
+
+    /**
+     * @brief Add node to tree, constructing it's value in place.
+     *
+     * @param[in] args: Arguments for value's constructor.
+     */
+    template <typename... Args>
+    void emplace(Args &&... args)
+    {
+        add_node(node_create(NULL, NULL, std::forward<Args>(args)...));
+    }
+
+    /**
+     * @brief Take read-only snapshot of tree (O(1): shares all nodes).
+     *
+     * @retval Pointer to new version (to be deleted by caller, in any thread).
+     */
+    const pbtree<T> *snapshot() const
+    {
+        return new pbtree<T>(*this);
+    }
+
+    /**
+     * @brief Find value.
+     *
+     * @param[in] value: Value.
+     *
+     * @retval NULL if value not found.
+     * @retval Pointer to value.
+     */
+    const T *find(const T &value) const
+    {
+        const pbtree_node<T> *p_node = p_root;
+
+        while ((p_node != NULL) && !(p_node->value == value))
+        {
+            p_node = (value < p_node->value) ? p_node->p_left :
+                                               p_node->p_right;
+        }
+
+        return (p_node == NULL) ? NULL : &p_node->value;
+    }
+
+    /**
+     * @brief Remove node with associated value (copying shared nodes on it's
+     *        path, and on it's successor's path if it has two children).
+     *
+     * @param[in] value: Value.
+     *
+     * @retval  true if node with associated value removed.
+     * @retval false if node with associated value not removed.
+     */
+    bool remove(const T &value)
+    {
+        pbtree_node<T> **pp_link = &p_root;
+        pbtree_node<T>  *p_node;
+        pbtree_node<T>  *p_successor;
+
+        if (find(value) == NULL)
+        {
+            return false; // nothing to copy
+        }
+
+        while (true)
+        {
+            p_node = unshare(pp_link);
+
+            if (p_node->value == value)
+            {
+                break;
+            }
+
+            pp_link = (value < p_node->value) ? &p_node->p_left :
+                                                &p_node->p_right;
+        }
+
+        if ((p_node->p_left == NULL) || (p_node->p_right == NULL))
+        {
+            // node's only child (if any) takes over node's link & reference
+
+            *pp_link = (p_node->p_left != NULL) ? p_node->p_left :
+                                                  p_node->p_right;
+
+            p_node->p_left  = NULL;
+            p_node->p_right = NULL;
+
+            node_release(p_node);
+        }
+        else
+        {
+            // in-order successor's value replaces node's, successor goes
+
+            pp_link = &p_node->p_right;
+
+            p_successor = unshare(pp_link);
+
+            while (p_successor->p_left != NULL)
+            {
+                pp_link = &p_successor->p_left;
+
+                p_successor = unshare(pp_link);
+            }
+
+            p_node->value = std::move(p_successor->value);
+
+            *pp_link = p_successor->p_right;
+
+            p_successor->p_right = NULL;
+
+            node_release(p_successor);
+        }
+
+        num_nodes--;
+
+        return true;
+    }
+
+    /**
+     * @brief Visit values in ascending order (iteratively; nodes are shared,
+     *        so they are not threaded as in btree).
+     *
+     * @param[in] visit: Visitor, called with each value (const T &).
+     */
+    template <typename Visitor>
+    void for_each(Visitor visit) const
+    {
+        const pbtree_node<T> **pp_stack;
+        const pbtree_node<T>  *p_node = p_root;
+
+        int num_stacked = 0;
+
+        pp_stack = new const pbtree_node<T> *[num_nodes + 1];
+
+        while ((p_node != NULL) || (num_stacked > 0))
+        {
+            if (p_node != NULL)
+            {
+                pp_stack[num_stacked++] = p_node;
+
+                p_node = p_node->p_left;
+            }
+            else
+            {
+                p_node = pp_stack[--num_stacked];
+
+                visit(p_node->value);
+
+                p_node = p_node->p_right;
+            }
+        }
+
+        delete [] pp_stack;
+    }
+
+    /**
+     * @brief Get depth of tree.
+     *
+     * @retval Depth of tree.
+     */
+    int depth() const
+    {
+        const pbtree_node<T> **pp_stack;
+        const pbtree_node<T>  *p_node;
+
+        int *p_depths;
+
+        int num_stacked = 0;
+        int depth_max   = 0;
+        int depth_node;
+
+        if (p_root == NULL)
+        {
+            return 0;
+        }
+
+        pp_stack = new const pbtree_node<T> *[num_nodes];
+        p_depths = new int[num_nodes];
+
+        pp_stack[num_stacked] = p_root;
+        p_depths[num_stacked] = 1;
+
+        num_stacked++;
+
+        while (num_stacked > 0)
+        {
+            num_stacked--;
+
+            p_node     = pp_stack[num_stacked];
+            depth_node = p_depths[num_stacked];
+
+            if (depth_node > depth_max)
+            {
+                depth_max = depth_node;
+            }
+
+            if (p_node->p_left != NULL)
+            {
+                pp_stack[num_stacked] = p_node->p_left;
+                p_depths[num_stacked] = depth_node + 1;
+
+                num_stacked++;
+            }
+
+            if (p_node->p_right != NULL)
+            {
+                pp_stack[num_stacked] = p_node->p_right;
+                p_depths[num_stacked] = depth_node + 1;
+
+                num_stacked++;
+            }
+        }
+
+        delete [] p_depths;
+        delete [] pp_stack;
+
+        return depth_max;
+    }
+
+    /**
+     * @brief Get number of nodes in tree.
+     *
+     * @retval Number of nodes.
+     */
+    int size() const
+    {
+        return num_nodes;
+    }
+
+    /**
+     * @brief Is tree empty?
+     *
+     * @retval  true if tree is empty
+     * @retval false if tree is not empty
+     */
+    bool is_empty() const
+    {
+        return (p_root == NULL) ? true : false;
+    }
+
+    /**
+     * @brief Verify tree by traversing it in-order and checking that no element
+     *        is greater than it's predecessor, that every node is referred to,
+     *        and that number of nodes is correct.
+     *
+     * @retval  true if binary tree is correct
+     * @retval false if binary tree is incorrect
+     */
+    bool verify() const
+    {
+        const T *p_value_prev = NULL;
+
+        bool retval = true;
+
+        int count = 0;
+
+        for_each([&](const T &value)
+                 {
+                     if ((p_value_prev != NULL) && (value < *p_value_prev))
+                     {
+                         retval = false;
+                     }
+
+                     p_value_prev = &value;
+
+                     count++;
+                 });
+
+        if ((p_root != NULL) && (p_root->refs.load() < 1))
+        {
+            retval = false;
+        }
+
+        return retval && (count == num_nodes);
+    }
+
+private:
+
+    // a version is changed through add & remove only
+
+    pbtree<T> &operator=(const pbtree<T> &other) = delete;
+
+    /**
+     * @brief Link new node into tree.
+     *
+     * @param[in,out] p_node_new: Pointer to new node structure.
+     */
+    void add_node(pbtree_node<T> *p_node_new)
+    {
+        pbtree_node<T> **pp_link = &p_root;
+        pbtree_node<T>  *p_node;
+
+        // follow links down to empty one, copying shared nodes
+
+        while (*pp_link != NULL)
+        {
+            p_node = unshare(pp_link);
+
+            pp_link = (p_node_new->value < p_node->value) ? &p_node->p_left :
+                                                            &p_node->p_right;
+        }
+
+        *pp_link = p_node_new;
+
+        num_nodes++;
+    }
+
+    /**
+     * @brief Make node behind link exclusively this version's: if it is
+     *        shared, replace it with a copy (the copy shares it's children).
+     *
+     * @param[in,out] pp_link: Pointer to link (in exclusive node or root).
+     *
+     * @retval Pointer to exclusive node.
+     */
+    pbtree_node<T> *unshare(pbtree_node<T> **pp_link)
+    {
+        pbtree_node<T> *p_node = *pp_link;
+        pbtree_node<T> *p_copy;
+
+        // acquire: other versions' reads of node are done once they let go
+
+        if (p_node->refs.load(std::memory_order_acquire) == 1)
+        {
+            return p_node;
+        }
+
+        p_copy = node_create(p_node->p_left, p_node->p_right, p_node->value);
+
+        *pp_link = p_copy;
+
+        node_release(p_node);
+
+        return p_copy;
+    }
+
+    /**
+     * @brief Create node, constructing it's value in place (taking references
+     *        to it's children).
+     *
+     * @param[in,out] p_left:  Pointer to left child node (may be NULL).
+     * @param[in,out] p_right: Pointer to right child node (may be NULL).
+     * @param[in]     args:    Arguments for value's constructor.
+     *
+     * @retval Pointer to new node structure.
+     */
+    template <typename... Args>
+    static pbtree_node<T> *node_create(pbtree_node<T> *p_left,
+                                       pbtree_node<T> *p_right,
+                                       Args &&... args)
+    {
+        pbtree_node<T> *p_node = new pbtree_node<T>(p_left, p_right, 1,
+                                                    std::forward<Args>(args)...);
+
+        node_retain(p_left);
+        node_retain(p_right);
+
+        return p_node;
+    }
+
+    /**
+     * @brief Take reference to node.
+     *
+     * @param[in,out] p_node: Pointer to node structure (may be NULL).
+     */
+    static void node_retain(pbtree_node<T> *p_node)
+    {
+        if (p_node != NULL)
+        {
+            p_node->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Drop reference to node, deleting it (& dropping it's references
+     *        to it's children) if it was the last one.
+     *
+     * Without recursion or extra memory: a deleted node's right child is
+     * released later, so until then the node is kept on a pending list
+     * (linked through it's now unused left link) while it's left child is
+     * released.
+     *
+     * @param[in,out] p_node: Pointer to node structure (may be NULL).
+     */
+    static void node_release(pbtree_node<T> *p_node)
+    {
+        pbtree_node<T> *p_pending = NULL;
+        pbtree_node<T> *p_next;
+
+        while (true)
+        {
+            // acq_rel: last owner sees every other owner's reads completed
+
+            if ((p_node != NULL) &&
+                (p_node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1))
+            {
+                p_next = p_node->p_left;
+
+                p_node->p_left = p_pending;
+
+                p_pending = p_node;
+
+                p_node = p_next;
+            }
+            else if (p_pending != NULL)
+            {
+                p_node = p_pending->p_right;
+
+                p_next = p_pending->p_left;
+
+                delete p_pending;
+
+                p_pending = p_next;
+            }
+            else
+            {
+                break;
+            }
+        }
+    }
+
+    pbtree_node<T> *p_root; ///< pointer to root node
+
+    int num_nodes; ///< number of nodes in tree
+};
+
+#endif // #ifndef _PBTREE_H_
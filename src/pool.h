@@ -0,0 +1,260 @@
+/**
+ * @file  pool.h
+ *
+ * @brief Node pool class.
+ */
+
+#ifndef _POOL_H_
+
+#define _POOL_H_
+
+#include <assert.h>
+#include <stddef.h>
+
+#define POOL_SLAB_SIZE_MIN 16 ///< minimum number of items per slab
+
+/// pool item structure (storage for one item, or link to next free item)
+template <typename T>
+union pool_item {
+    pool_item<T> *p_next;                    ///< pointer to next free item
+    alignas(T) unsigned char data[sizeof(T)]; ///< item storage
+};
+
+/**
+ * @brief Pool class.
+ *
+ * Hands out storage for items of type T from slabs (arrays of items) and
+ * recycles released items through a free list, so that steady-state
+ * alloc()/release() never touch the global heap. Slabs are only returned to
+ * the heap when the pool is destroyed.
+ *
+ * The pool only manages storage: callers construct items in storage returned
+ * by alloc() (placement new) and destroy them before calling release().
+ */
+template <typename T>
+class pool
+{
+public:
+
+    /**
+     * @brief Constructor.
+     */
+    pool()
+    {
+        p_free       = NULL;
+        p_free_tail  = NULL;
+        p_slabs      = NULL;
+        p_slabs_tail = NULL;
+
+        num_items = 0;
+        num_free  = 0;
+    }
+
+    /**
+     * @brief Destructor.
+     */
+    ~pool()
+    {
+        pool_item<T> *p_slab;
+
+        while (p_slabs != NULL)
+        {
+            p_slab = p_slabs;
+
+            p_slabs = p_slabs->p_next;
+
+            delete [] p_slab;
+        }
+
+        p_free       = NULL;
+        p_free_tail  = NULL;
+        p_slabs_tail = NULL;
+    }
+
+    /**
+     * @brief Allocate storage for one item.
+     *
+     * @retval Pointer to (uninitialised) item storage.
+     */
+    T *alloc()
+    {
+        pool_item<T> *p_item;
+
+        if (p_free == NULL)
+        {
+            // grow geometrically, so that the number of slabs stays small
+
+            slab_create((num_items > POOL_SLAB_SIZE_MIN) ?
+                        num_items : POOL_SLAB_SIZE_MIN);
+        }
+
+        p_item = p_free;
+
+        p_free = p_free->p_next;
+
+        if (p_free == NULL)
+        {
+            p_free_tail = NULL;
+        }
+
+        num_free--;
+
+        return reinterpret_cast<T *>(p_item->data);
+    }
+
+    /**
+     * @brief Release storage for one item back to pool.
+     *
+     * @param[in] p_data: Pointer to item storage (obtained from alloc()).
+     */
+    void release(T *p_data)
+    {
+        pool_item<T> *p_item;
+
+        assert(p_data != NULL);
+
+        p_item = reinterpret_cast<pool_item<T> *>(p_data);
+
+        free_push(p_item);
+    }
+
+    /**
+     * @brief Make sure that at least a specific number of items can be
+     *        allocated without growing pool.
+     *
+     * @param[in] count: Number of items.
+     */
+    void reserve(int count)
+    {
+        if (count > num_free)
+        {
+            slab_create(count - num_free);
+        }
+    }
+
+    /**
+     * @brief Get number of items in pool (allocated or free).
+     *
+     * @retval Number of items.
+     */
+    int size() const
+    {
+        return num_items;
+    }
+
+    /**
+     * @brief Take over other pool's slabs & free items (O(1)).
+     *
+     * Items allocated from other pool stay valid and may afterwards be
+     * released to this pool; other pool is left empty.
+     *
+     * @param[in,out] other: Other pool.
+     */
+    void merge(pool<T> &other)
+    {
+        if (other.p_slabs == NULL)
+        {
+            return;
+        }
+
+        other.p_slabs_tail->p_next = p_slabs;
+
+        p_slabs = other.p_slabs;
+
+        if (p_slabs_tail == NULL)
+        {
+            p_slabs_tail = other.p_slabs_tail;
+        }
+
+        if (other.p_free != NULL)
+        {
+            other.p_free_tail->p_next = p_free;
+
+            p_free = other.p_free;
+
+            if (p_free_tail == NULL)
+            {
+                p_free_tail = other.p_free_tail;
+            }
+        }
+
+        num_items += other.num_items;
+        num_free  += other.num_free;
+
+        other.p_free       = NULL;
+        other.p_free_tail  = NULL;
+        other.p_slabs      = NULL;
+        other.p_slabs_tail = NULL;
+
+        other.num_items = 0;
+        other.num_free  = 0;
+    }
+
+private:
+
+    /**
+     * @brief Push item onto free list.
+     *
+     * @param[in,out] p_item: Pointer to item.
+     */
+    void free_push(pool_item<T> *p_item)
+    {
+        p_item->p_next = p_free;
+
+        if (p_free == NULL)
+        {
+            p_free_tail = p_item;
+        }
+
+        p_free = p_item;
+
+        num_free++;
+    }
+
+    /**
+     * @brief Create slab & add it's items to free list.
+     *
+     * The first item of each slab is used to link slabs together; the rest
+     * are handed out.
+     *
+     * @param[in] count: Number of items in slab.
+     */
+    void slab_create(int count)
+    {
+        pool_item<T> *p_slab;
+
+        int ii;
+
+        assert(count > 0);
+
+        p_slab = new pool_item<T>[count + 1];
+
+        p_slab[0].p_next = p_slabs;
+
+        if (p_slabs == NULL)
+        {
+            p_slabs_tail = p_slab;
+        }
+
+        p_slabs = p_slab;
+
+        // push items in reverse, so that they are handed out in address order
+
+        for (ii = count; ii >= 1; ii--)
+        {
+            free_push(&p_slab[ii]);
+        }
+
+        num_items += count;
+    }
+
+    pool_item<T> *p_free;       ///< pointer to first free item
+    pool_item<T> *p_free_tail;  ///< pointer to last free item
+    pool_item<T> *p_slabs;      ///< pointer to first slab
+    pool_item<T> *p_slabs_tail; ///< pointer to last slab
+
+    int num_items; ///< number of items in pool
+    int num_free;  ///< number of free items in pool
+};
+
+#endif // #ifndef _POOL_H_
@@ -0,0 +1,434 @@
+/**
+ * @file  ppqueue.h
+ *
+ * @brief Meldable priority queue class (pairing heap).
+ */
+
+#ifndef _PPQUEUE_H_
+
+#define _PPQUEUE_H_
+
+#include <assert.h>
+#include <stddef.h>
+#include <new>
+#include <utility>
+
+#include "pool.h"
+
+/// pairing heap node structure
+template <typename T>
+struct ppqueue_node {
+    T                value;     ///< node value
+    ppqueue_node<T> *p_child;   ///< pointer to first child
+    ppqueue_node<T> *p_sibling; ///< pointer to next sibling
+
+    /**
+     * @brief Constructor, constructing value in place.
+     *
+     * @param[in] p_child:   Pointer to first child.
+     * @param[in] p_sibling: Pointer to next sibling.
+     * @param[in] args:      Arguments for value's constructor.
+     */
+    template <typename... Args>
+    ppqueue_node(ppqueue_node<T> *p_child, ppqueue_node<T> *p_sibling,
+                 Args &&... args) :
+        value(std::forward<Args>(args)...), p_child(p_child),
+        p_sibling(p_sibling)
+    {
+    }
+};
+
+/**
+ * @brief Meldable priority queue class (pairing heap).
+ *
+ * Same enqueue/dequeue/is_empty interface as pqueue, plus meld(): enqueue and
+ * meld are O(1) (a single comparison links two heaps), dequeue is amortized
+ * O(log n) (two-pass pairing of the removed root's children).
+ *
+ * Nodes come from a pool; meld() takes over the other queue's pool along with
+ * it's nodes, so no node is copied or reallocated.
+ *
+ * Unlike pqueue, items with equal priority are not dequeued in FIFO order.
+ */
+template <typename T>
+class ppqueue
+{
+public:
+
+    /**
+     * @brief Constructor.
+     */
+    ppqueue()
+    {
+        p_root = NULL;
+
+        num_items = 0;
+    }
+
+    /**
+     * @brief Destructor.
+     */
+    ~ppqueue()
+    {
+        clear();
+    }
+
+    /**
+     * @brief Enqueue value.
+     *
+     * @param[in] value: Value.
+     */
+    void enqueue(const T &value)
+    {
+        p_root = link(p_root, node_create(value));
+
+        num_items++;
+    }
+
+    /**
+     * @brief Enqueue value (moving value).
+     *
+     * @param[in,out] value: Value.
+     */
+    void enqueue(T &&value)
+    {
+        p_root = link(p_root, node_create(std::move(value)));
+
+        num_items++;
+    }
+
+    /**
+     * @brief Enqueue value, constructing it in place.
+     *
+     * @param[in] args: Arguments for value's constructor.
+     */
+    template <typename... Args>
+    void emplace(Args &&... args)
+    {
+        p_root = link(p_root, node_create(std::forward<Args>(args)...));
+
+        num_items++;
+    }
+
+    /**
+     * @brief Dequeue value.
+     *
+     * @retval Value with highest priority (smallest value).
+     */
+    T dequeue()
+    {
+        ppqueue_node<T> *p_node = p_root;
+
+        assert(p_node != NULL);
+
+        T value(std::move(p_node->value));
+
+        p_root = pair(p_node->p_child);
+
+        num_items--;
+
+        node_delete(p_node);
+
+        return value;
+    }
+
+    /**
+     * @brief Dequeue value if queue is not empty.
+     *
+     * @param[out] value: Value with highest priority (smallest value).
+     *
+     * @retval  true if value dequeued
+     * @retval false if queue is empty
+     */
+    bool try_dequeue(T &value)
+    {
+        if (p_root == NULL)
+        {
+            return false;
+        }
+
+        value = dequeue();
+
+        return true;
+    }
+
+    /**
+     * @brief Peek value with highest priority.
+     *
+     * @retval Reference to value with highest priority (smallest value).
+     */
+    const T &peek() const
+    {
+        assert(p_root != NULL);
+
+        return p_root->value;
+    }
+
+    /**
+     * @brief Move all of other queue's items into this queue (O(1)).
+     *
+     * @param[in,out] other: Other queue (empty afterwards).
+     */
+    void meld(ppqueue<T> &other)
+    {
+        if (&other == this)
+        {
+            return;
+        }
+
+        p_root = link(p_root, other.p_root);
+
+        num_items += other.num_items;
+
+        node_pool.merge(other.node_pool);
+
+        other.p_root = NULL;
+
+        other.num_items = 0;
+    }
+
+    /**
+     * @brief Is queue empty?
+     *
+     * @retval  true if queue is empty
+     * @retval false if queue is not empty
+     */
+    bool is_empty() const
+    {
+        return (p_root == NULL) ? true : false;
+    }
+
+    /**
+     * @brief Get number of items in queue.
+     *
+     * @retval Number of items.
+     */
+    int size() const
+    {
+        return num_items;
+    }
+
+    /**
+     * @brief Make sure that at least a specific number of items can be
+     *        enqueued without allocating.
+     *
+     * @param[in] count: Number of items.
+     */
+    void reserve(int count)
+    {
+        node_pool.reserve(count);
+    }
+
+    /**
+     * @brief Verify heap by checking that no item is smaller than it's parent
+     *        and that all items are reachable.
+     *
+     * @retval  true if heap is correct
+     * @retval false if heap is incorrect
+     */
+    bool verify() const
+    {
+        ppqueue_node<T> **pp_stack;
+        ppqueue_node<T>  *p_node;
+        ppqueue_node<T>  *p_child;
+
+        int num_stacked = 0;
+        int num_visited = 0;
+
+        bool correct = true;
+
+        if (p_root == NULL)
+        {
+            return num_items == 0;
+        }
+
+        pp_stack = new ppqueue_node<T> *[num_items];
+
+        pp_stack[num_stacked++] = p_root;
+
+        while (correct && (num_stacked > 0))
+        {
+            p_node = pp_stack[--num_stacked];
+
+            num_visited++;
+
+            for (p_child = p_node->p_child; p_child != NULL;
+                 p_child = p_child->p_sibling)
+            {
+                if ((p_child->value < p_node->value) ||
+                    (num_visited + num_stacked >= num_items))
+                {
+                    correct = false;
+                    break;
+                }
+
+                pp_stack[num_stacked++] = p_child;
+            }
+        }
+
+        delete [] pp_stack;
+
+        return correct && (num_visited == num_items) &&
+               (p_root->p_sibling == NULL);
+    }
+
+    ppqueue_node<T> *p_root; ///< pointer to root node
+
+private:
+
+    /**
+     * @brief Link two heaps: root with larger value becomes first child of
+     *        the other.
+     *
+     * @param[in,out] p_a: Pointer to root of first heap (may be NULL).
+     * @param[in,out] p_b: Pointer to root of second heap (may be NULL).
+     *
+     * @retval Pointer to root of linked heap.
+     */
+    static ppqueue_node<T> *link(ppqueue_node<T> *p_a, ppqueue_node<T> *p_b)
+    {
+        if (p_a == NULL)
+        {
+            return p_b;
+        }
+
+        if (p_b == NULL)
+        {
+            return p_a;
+        }
+
+        if (p_b->value < p_a->value)
+        {
+            std::swap(p_a, p_b);
+        }
+
+        p_b->p_sibling = p_a->p_child;
+
+        p_a->p_child = p_b;
+
+        return p_a;
+    }
+
+    /**
+     * @brief Combine sibling list into one heap (two-pass pairing).
+     *
+     * First pass links siblings pairwise from left to right, pushing each
+     * pair onto a list that ends up in reverse order; second pass links that
+     * list from right to left (i.e. in it's order) into one heap.
+     *
+     * @param[in,out] p_first: Pointer to first sibling (may be NULL).
+     *
+     * @retval Pointer to root of combined heap.
+     */
+    static ppqueue_node<T> *pair(ppqueue_node<T> *p_first)
+    {
+        ppqueue_node<T> *p_pairs = NULL;
+        ppqueue_node<T> *p_root  = NULL;
+        ppqueue_node<T> *p_a;
+        ppqueue_node<T> *p_b;
+
+        while (p_first != NULL)
+        {
+            p_a = p_first;
+            p_b = p_a->p_sibling;
+
+            if (p_b == NULL)
+            {
+                p_first = NULL;
+            }
+            else
+            {
+                p_first = p_b->p_sibling;
+
+                p_b->p_sibling = NULL;
+            }
+
+            p_a->p_sibling = NULL;
+
+            p_a = link(p_a, p_b);
+
+            p_a->p_sibling = p_pairs;
+
+            p_pairs = p_a;
+        }
+
+        while (p_pairs != NULL)
+        {
+            p_a = p_pairs;
+
+            p_pairs = p_pairs->p_sibling;
+
+            p_a->p_sibling = NULL;
+
+            p_root = link(p_root, p_a);
+        }
+
+        return p_root;
+    }
+
+    /**
+     * @brief Delete all nodes (iteratively, rotating children into sibling
+     *        position, so no stack is needed).
+     */
+    void clear()
+    {
+        ppqueue_node<T> *p_node = p_root;
+        ppqueue_node<T> *p_next;
+
+        while (p_node != NULL)
+        {
+            if (p_node->p_child == NULL)
+            {
+                p_next = p_node->p_sibling;
+
+                node_delete(p_node);
+            }
+            else
+            {
+                p_next = p_node->p_child;
+
+                p_node->p_child = p_next->p_sibling;
+
+                p_next->p_sibling = p_node;
+            }
+
+            p_node = p_next;
+        }
+
+        p_root = NULL;
+
+        num_items = 0;
+    }
+
+    /**
+     * @brief Create node, constructing it's value in place.
+     *
+     * @param[in] args: Arguments for value's constructor.
+     *
+     * @retval Pointer to node structure.
+     */
+    template <typename... Args>
+    ppqueue_node<T> *node_create(Args &&... args)
+    {
+        return new (node_pool.alloc())
+               ppqueue_node<T>(NULL, NULL, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Delete node.
+     *
+     * @param[in] p_node: Pointer to node structure.
+     */
+    void node_delete(ppqueue_node<T> *p_node)
+    {
+        p_node->~ppqueue_node<T>();
+
+        node_pool.release(p_node);
+    }
+
+    int num_items; ///< number of items in queue
+
+    pool< ppqueue_node<T> > node_pool; ///< node pool
+};
+
+#endif // #ifndef _PPQUEUE_H_
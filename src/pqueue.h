@@ -8,6 +8,8 @@
 
 #define _PQUEUE_H_
 
+#include <utility>
+
 #include "llist.h"
 
 /// queue class
@@ -39,34 +41,39 @@ public:
      *
      * @param[in] value: Value.
      */
-    void enqueue(T value)
+    void enqueue(const T &value)
     {
-        llist_node<T> *p_node;
-
-        p_node = p_llist->p_head;
-
-        while (p_node != NULL)
-        {
-            if (value < p_node->value)
-            {
-                break;
-            }
+        p_llist->insert_after(find_prev(value), value);
 
-            p_node = p_node->p_next;
-        }
+        num_items++;
+    }
 
-        if (p_node == NULL)
-        {
-            p_llist->add_tail(value);
-        }
-        else
-        {
-            p_llist->add_before(p_node, value);
-        }
+    /**
+     * @brief Enqueue value (moving value).
+     *
+     * @param[in,out] value: Value.
+     */
+    void enqueue(T &&value)
+    {
+        p_llist->insert_after(find_prev(value), std::move(value));
 
         num_items++;
     }
 
+    /**
+     * @brief Enqueue value, constructing it from arguments.
+     *
+     * The value has to exist before it's position can be found, so it is
+     * constructed once here and then moved into it's node.
+     *
+     * @param[in] args: Arguments for value's constructor.
+     */
+    template <typename... Args>
+    void emplace(Args &&... args)
+    {
+        enqueue(T(std::forward<Args>(args)...));
+    }
+
     /**
      * @brief Dequeue value.
      *
@@ -74,11 +81,9 @@ public:
      */
     T dequeue()
     {
-        T value;
-
         assert(num_items > 0);
 
-        value = p_llist->p_head->value;
+        T value(std::move(p_llist->p_head->value));
 
         p_llist->delete_head();
 
@@ -87,6 +92,26 @@ public:
         return value;
     }
 
+    /**
+     * @brief Dequeue value if queue is not empty.
+     *
+     * @param[out] value: Value at head of queue.
+     *
+     * @retval  true if value dequeued
+     * @retval false if queue is empty
+     */
+    bool try_dequeue(T &value)
+    {
+        if (p_llist->pop_head(value) == false)
+        {
+            return false;
+        }
+
+        num_items--;
+
+        return true;
+    }
+
     /**
      * @brief Is queue empty?
      *
@@ -98,10 +123,51 @@ public:
         return (num_items == 0) ? true : false;
     }
 
+    /**
+     * @brief Make sure that at least a specific number of values can be
+     *        enqueued without allocating memory from heap.
+     *
+     * @param[in] count: Number of values.
+     */
+    void reserve(int count)
+    {
+        p_llist->reserve(count);
+    }
+
     llist<T> *p_llist; ///< pointer to linked list
 
 private:
 
+    /**
+     * @brief Find node after which value is to be inserted (i.e. last node
+     *        with value not greater than value).
+     *
+     * @param[in] value: Value.
+     *
+     * @retval NULL if value is to be inserted at head of list.
+     * @retval Pointer to predecessor node.
+     */
+    llist_node<T> *find_prev(const T &value)
+    {
+        llist_node<T> *p_prev = NULL;
+        llist_node<T> *p_node;
+
+        p_node = p_llist->p_head;
+
+        while (p_node != NULL)
+        {
+            if (value < p_node->value)
+            {
+                break;
+            }
+
+            p_prev = p_node;
+            p_node = p_node->p_next;
+        }
+
+        return p_prev;
+    }
+
     int num_items; ///< number of items in queue
 };
 
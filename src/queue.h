@@ -8,6 +8,8 @@
 
 #define _QUEUE_H_
 
+#include <utility>
+
 #include "llist.h"
 
 /// queue class
@@ -39,13 +41,38 @@ public:
      *
      * @param[in] value: Value.
      */
-    void enqueue(T value)
+    void enqueue(const T &value)
     {
         p_llist->add_tail(value);
 
         num_items++;
     }
 
+    /**
+     * @brief Enqueue value (moving value).
+     *
+     * @param[in,out] value: Value.
+     */
+    void enqueue(T &&value)
+    {
+        p_llist->add_tail(std::move(value));
+
+        num_items++;
+    }
+
+    /**
+     * @brief Enqueue value, constructing it in place.
+     *
+     * @param[in] args: Arguments for value's constructor.
+     */
+    template <typename... Args>
+    void emplace(Args &&... args)
+    {
+        p_llist->emplace_tail(std::forward<Args>(args)...);
+
+        num_items++;
+    }
+
     /**
      * @brief Dequeue value.
      *
@@ -53,11 +80,9 @@ public:
      */
     T dequeue()
     {
-        T value;
-
         assert(num_items > 0);
 
-        value = p_llist->p_head->value;
+        T value(std::move(p_llist->p_head->value));
 
         p_llist->delete_head();
 
@@ -66,6 +91,26 @@ public:
         return value;
     }
 
+    /**
+     * @brief Dequeue value if queue is not empty.
+     *
+     * @param[out] value: Value at head of queue.
+     *
+     * @retval  true if value dequeued
+     * @retval false if queue is empty
+     */
+    bool try_dequeue(T &value)
+    {
+        if (p_llist->pop_head(value) == false)
+        {
+            return false;
+        }
+
+        num_items--;
+
+        return true;
+    }
+
     /**
      * @brief Is queue empty?
      *
@@ -77,6 +122,17 @@ public:
         return (num_items == 0) ? true : false;
     }
 
+    /**
+     * @brief Make sure that at least a specific number of values can be
+     *        enqueued without allocating memory from heap.
+     *
+     * @param[in] count: Number of values.
+     */
+    void reserve(int count)
+    {
+        p_llist->reserve(count);
+    }
+
     llist<T> *p_llist; ///< pointer to linked list
 
 private:
@@ -0,0 +1,352 @@
+/**
+ * @file  rpqueue.h
+ *
+ * @brief Monotone priority queue class for integer keys (radix heap).
+ */
+
+#ifndef _RPQUEUE_H_
+
+#define _RPQUEUE_H_
+
+#include <assert.h>
+#include <stddef.h>
+#include <limits.h>
+#include <type_traits>
+
+#define RPQUEUE_BUCKET_SIZE_MIN 16 ///< minimum number of keys per bucket
+
+/// radix heap bucket structure (growable key array)
+template <typename U>
+struct rpqueue_bucket {
+    U  *p_keys;   ///< pointer to key array
+    int num_keys; ///< number of keys in bucket
+    int capacity; ///< number of keys allocated
+};
+
+/**
+ * @brief Monotone priority queue class (radix heap).
+ *
+ * Same enqueue/dequeue/is_empty interface as pqueue, for integer keys, with
+ * one restriction: a key must never be smaller than the last dequeued key
+ * (as with timestamps in an event simulation). In exchange, no key is ever
+ * compared to another one: keys are kept in buckets by the highest bit in
+ * which they differ from the last dequeued key (bucket 0: equal to it), and
+ * when bucket 0 runs empty, the first non-empty bucket is emptied into lower
+ * buckets relative to it's smallest key. A key only ever moves to lower
+ * buckets, so both operations are amortized O(log C) (C: key range), and
+ * buckets are plain arrays, scanned sequentially.
+ *
+ * Signed keys are mapped to unsigned ones by flipping the sign bit, which
+ * preserves their order.
+ */
+template <typename T>
+class rpqueue
+{
+    static_assert(std::is_integral<T>::value,
+                  "radix heap keys must be integers");
+
+    typedef typename std::make_unsigned<T>::type U; ///< unsigned key type
+
+    static const int NUM_BITS    = sizeof(U) * CHAR_BIT; ///< key width
+    static const int NUM_BUCKETS = NUM_BITS + 1;         ///< number of buckets
+
+public:
+
+    /**
+     * @brief Constructor.
+     */
+    rpqueue()
+    {
+        int ii;
+
+        for (ii = 0; ii < NUM_BUCKETS; ii++)
+        {
+            buckets[ii].p_keys   = NULL;
+            buckets[ii].num_keys = 0;
+            buckets[ii].capacity = 0;
+        }
+
+        last = 0;
+
+        num_items = 0;
+    }
+
+    /**
+     * @brief Destructor.
+     */
+    ~rpqueue()
+    {
+        int ii;
+
+        for (ii = 0; ii < NUM_BUCKETS; ii++)
+        {
+            delete [] buckets[ii].p_keys;
+        }
+    }
+
+    /**
+     * @brief Enqueue value.
+     *
+     * @param[in] value: Value (not smaller than last dequeued value).
+     */
+    void enqueue(T value)
+    {
+        U key = key_from_value(value);
+
+        assert(!(key < last));
+
+        bucket_push(&buckets[bucket_index(key)], key);
+
+        num_items++;
+    }
+
+    /**
+     * @brief Dequeue value.
+     *
+     * @retval Value with highest priority (smallest value).
+     */
+    T dequeue()
+    {
+        assert(num_items > 0);
+
+        if (buckets[0].num_keys == 0)
+        {
+            redistribute();
+        }
+
+        buckets[0].num_keys--;
+
+        num_items--;
+
+        return value_from_key(last);
+    }
+
+    /**
+     * @brief Dequeue value if queue is not empty.
+     *
+     * @param[out] value: Value with highest priority (smallest value).
+     *
+     * @retval  true if value dequeued
+     * @retval false if queue is empty
+     */
+    bool try_dequeue(T &value)
+    {
+        if (num_items == 0)
+        {
+            return false;
+        }
+
+        value = dequeue();
+
+        return true;
+    }
+
+    /**
+     * @brief Peek value with highest priority.
+     *
+     * @retval Value with highest priority (smallest value).
+     */
+    T peek() const
+    {
+        const rpqueue_bucket<U> *p_bucket = buckets;
+
+        assert(num_items > 0);
+
+        while (p_bucket->num_keys == 0)
+        {
+            p_bucket++;
+        }
+
+        return value_from_key(bucket_min(p_bucket));
+    }
+
+    /**
+     * @brief Is queue empty?
+     *
+     * @retval  true if queue is empty
+     * @retval false if queue is not empty
+     */
+    bool is_empty() const
+    {
+        return (num_items == 0) ? true : false;
+    }
+
+    /**
+     * @brief Get number of items in queue.
+     *
+     * @retval Number of items.
+     */
+    int size() const
+    {
+        return num_items;
+    }
+
+    /**
+     * @brief Verify heap by checking that every key is in the bucket it
+     *        belongs in.
+     *
+     * @retval  true if heap is correct
+     * @retval false if heap is incorrect
+     */
+    bool verify() const
+    {
+        int count = 0;
+        int ii, jj;
+
+        for (ii = 0; ii < NUM_BUCKETS; ii++)
+        {
+            for (jj = 0; jj < buckets[ii].num_keys; jj++)
+            {
+                if ((buckets[ii].p_keys[jj] < last) ||
+                    (bucket_index(buckets[ii].p_keys[jj]) != ii))
+                {
+                    return false;
+                }
+            }
+
+            count += buckets[ii].num_keys;
+        }
+
+        return count == num_items;
+    }
+
+private:
+
+    /**
+     * @brief Map value to (order-preserving) unsigned key.
+     *
+     * @param[in] value: Value.
+     *
+     * @retval Key.
+     */
+    static U key_from_value(T value)
+    {
+        return std::is_signed<T>::value ?
+               (U)((U)value ^ ((U)1 << (NUM_BITS - 1))) : (U)value;
+    }
+
+    /**
+     * @brief Map unsigned key back to value.
+     *
+     * @param[in] key: Key.
+     *
+     * @retval Value.
+     */
+    static T value_from_key(U key)
+    {
+        return std::is_signed<T>::value ?
+               (T)(U)(key ^ ((U)1 << (NUM_BITS - 1))) : (T)key;
+    }
+
+    /**
+     * @brief Get index of bucket key belongs in: 0 if key equals last
+     *        dequeued key, else 1 + index of highest differing bit.
+     *
+     * @param[in] key: Key.
+     *
+     * @retval Bucket index.
+     */
+    int bucket_index(U key) const
+    {
+        unsigned long long diff = (unsigned long long)(key ^ last);
+
+        if (diff == 0)
+        {
+            return 0;
+        }
+
+        return (int)(sizeof(unsigned long long) * CHAR_BIT) -
+               __builtin_clzll(diff);
+    }
+
+    /**
+     * @brief Find smallest key in (non-empty) bucket.
+     *
+     * @param[in] p_bucket: Pointer to bucket.
+     *
+     * @retval Smallest key.
+     */
+    static U bucket_min(const rpqueue_bucket<U> *p_bucket)
+    {
+        U min = p_bucket->p_keys[0];
+
+        int ii;
+
+        for (ii = 1; ii < p_bucket->num_keys; ii++)
+        {
+            if (p_bucket->p_keys[ii] < min)
+            {
+                min = p_bucket->p_keys[ii];
+            }
+        }
+
+        return min;
+    }
+
+    /**
+     * @brief Append key to bucket.
+     *
+     * @param[in,out] p_bucket: Pointer to bucket.
+     * @param[in]     key:      Key.
+     */
+    static void bucket_push(rpqueue_bucket<U> *p_bucket, U key)
+    {
+        U *p_keys_new;
+
+        int ii;
+
+        if (p_bucket->num_keys == p_bucket->capacity)
+        {
+            p_bucket->capacity = (p_bucket->capacity > 0) ?
+                                 (p_bucket->capacity * 2) :
+                                 RPQUEUE_BUCKET_SIZE_MIN;
+
+            p_keys_new = new U[p_bucket->capacity];
+
+            for (ii = 0; ii < p_bucket->num_keys; ii++)
+            {
+                p_keys_new[ii] = p_bucket->p_keys[ii];
+            }
+
+            delete [] p_bucket->p_keys;
+
+            p_bucket->p_keys = p_keys_new;
+        }
+
+        p_bucket->p_keys[p_bucket->num_keys++] = key;
+    }
+
+    /**
+     * @brief Refill bucket 0: make smallest key of first non-empty bucket the
+     *        last dequeued key & move that bucket's keys to lower buckets.
+     */
+    void redistribute()
+    {
+        rpqueue_bucket<U> *p_bucket = &buckets[1];
+
+        int ii;
+
+        while (p_bucket->num_keys == 0)
+        {
+            p_bucket++;
+        }
+
+        last = bucket_min(p_bucket);
+
+        for (ii = 0; ii < p_bucket->num_keys; ii++)
+        {
+            bucket_push(&buckets[bucket_index(p_bucket->p_keys[ii])],
+                        p_bucket->p_keys[ii]);
+        }
+
+        p_bucket->num_keys = 0;
+    }
+
+    rpqueue_bucket<U> buckets[NUM_BUCKETS]; ///< buckets
+
+    U last; ///< last dequeued key
+
+    int num_items; ///< number of items in queue
+};
+
+#endif // #ifndef _RPQUEUE_H_
@@ -0,0 +1,220 @@
+/**
+ * @file  spscqueue.h
+ *
+ * @brief Single-producer/single-consumer (wait-free) queue class.
+ */
+
+#ifndef _SPSCQUEUE_H_
+
+#define _SPSCQUEUE_H_
+
+#include <assert.h>
+#include <stddef.h>
+#include <atomic>
+#include <utility>
+
+#define SPSCQUEUE_CACHE_LINE_SIZE 64 ///< cache line size in bytes
+
+/**
+ * @brief Single-producer/single-consumer queue class.
+ *
+ * Bounded ring buffer of power-of-two size: one thread may enqueue while
+ * another dequeues, without locks and without allocating. Head & tail are
+ * free-running indices on separate cache lines; each side also keeps a
+ * cached copy of the other side's index and only re-reads the shared one
+ * when the cached copy says the queue is full (producer) or empty (consumer).
+ */
+template <typename T>
+class spscqueue
+{
+public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] capacity: Minimum number of items queue can hold (rounded up
+     *                      to power of two).
+     */
+    explicit spscqueue(int capacity)
+    {
+        size_t size = 1;
+
+        assert(capacity > 0);
+
+        while (size < (size_t)capacity)
+        {
+            size <<= 1;
+        }
+
+        p_items = new T[size];
+
+        mask = size - 1;
+
+        head.store(0);
+        tail.store(0);
+
+        head_cache = 0;
+        tail_cache = 0;
+    }
+
+    /**
+     * @brief Destructor.
+     */
+    ~spscqueue()
+    {
+        delete [] p_items;
+    }
+
+    /**
+     * @brief Enqueue value (producer only).
+     *
+     * @param[in] value: Value.
+     *
+     * @retval  true if value enqueued
+     * @retval false if queue is full
+     */
+    bool enqueue(const T &value)
+    {
+        size_t index;
+
+        if (slot_acquire(&index) == false)
+        {
+            return false;
+        }
+
+        p_items[index & mask] = value;
+
+        tail.store(index + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+     * @brief Enqueue value (producer only, moving value).
+     *
+     * @param[in,out] value: Value (only moved from if enqueued).
+     *
+     * @retval  true if value enqueued
+     * @retval false if queue is full
+     */
+    bool enqueue(T &&value)
+    {
+        size_t index;
+
+        if (slot_acquire(&index) == false)
+        {
+            return false;
+        }
+
+        p_items[index & mask] = std::move(value);
+
+        tail.store(index + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+     * @brief Dequeue value (consumer only).
+     *
+     * @retval Value at head of queue.
+     */
+    T dequeue()
+    {
+        T value;
+
+        bool dequeued = try_dequeue(value);
+
+        assert(dequeued);
+
+        (void)dequeued;
+
+        return value;
+    }
+
+    /**
+     * @brief Dequeue value if queue is not empty (consumer only).
+     *
+     * @param[out] value: Value at head of queue.
+     *
+     * @retval  true if value dequeued
+     * @retval false if queue is empty
+     */
+    bool try_dequeue(T &value)
+    {
+        size_t index = head.load(std::memory_order_relaxed);
+
+        if (index == tail_cache)
+        {
+            tail_cache = tail.load(std::memory_order_acquire);
+
+            if (index == tail_cache)
+            {
+                return false;
+            }
+        }
+
+        value = std::move(p_items[index & mask]);
+
+        head.store(index + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+     * @brief Is queue empty?
+     *
+     * @retval  true if queue is empty
+     * @retval false if queue is not empty
+     */
+    bool is_empty()
+    {
+        return head.load(std::memory_order_acquire) ==
+               tail.load(std::memory_order_acquire);
+    }
+
+private:
+
+    /**
+     * @brief Get index of next free slot (producer only).
+     *
+     * @param[out] p_index: Pointer to slot index (free-running).
+     *
+     * @retval  true if slot available
+     * @retval false if queue is full
+     */
+    bool slot_acquire(size_t *p_index)
+    {
+        size_t index = tail.load(std::memory_order_relaxed);
+
+        if (index - head_cache > mask)
+        {
+            head_cache = head.load(std::memory_order_acquire);
+
+            if (index - head_cache > mask)
+            {
+                return false;
+            }
+        }
+
+        *p_index = index;
+
+        return true;
+    }
+
+    T     *p_items; ///< pointer to item array
+    size_t mask;    ///< item array size - 1
+
+    char pad_0[SPSCQUEUE_CACHE_LINE_SIZE]; ///< keep producer's line apart
+
+    std::atomic<size_t> tail;       ///< next slot to enqueue into
+    size_t              head_cache; ///< producer's copy of head
+
+    char pad_1[SPSCQUEUE_CACHE_LINE_SIZE]; ///< keep consumer's line apart
+
+    std::atomic<size_t> head;       ///< next slot to dequeue from
+    size_t              tail_cache; ///< consumer's copy of tail
+
+    char pad_2[SPSCQUEUE_CACHE_LINE_SIZE]; ///< keep neighbours apart
+};
+
+#endif // #ifndef _SPSCQUEUE_H_
@@ -8,6 +8,8 @@
 
 #define _STACK_H_
 
+#include <utility>
+
 #include "llist.h"
 
 /// stack class
@@ -37,11 +39,32 @@ public:
      *
      * @param[in] value: Value.
      */
-    void push(T value)
+    void push(const T &value)
     {
         p_llist->add_head(value);
     }
 
+    /**
+     * @brief Push value onto stack (moving value).
+     *
+     * @param[in,out] value: Value.
+     */
+    void push(T &&value)
+    {
+        p_llist->add_head(std::move(value));
+    }
+
+    /**
+     * @brief Push value onto stack, constructing it in place.
+     *
+     * @param[in] args: Arguments for value's constructor.
+     */
+    template <typename... Args>
+    void emplace(Args &&... args)
+    {
+        p_llist->emplace_head(std::forward<Args>(args)...);
+    }
+
     /**
      * @brief Pop value from stack.
      *
@@ -49,29 +72,51 @@ public:
      */
     T pop()
     {
-        T value;
-
         assert(p_llist->p_head != NULL);
 
-        value = p_llist->p_head->value;
+        T value(std::move(p_llist->p_head->value));
 
         p_llist->delete_head();
 
         return value;
     }
 
+    /**
+     * @brief Pop value from stack if stack is not empty.
+     *
+     * @param[out] value: Value at top of stack.
+     *
+     * @retval  true if value popped
+     * @retval false if stack is empty
+     */
+    bool try_pop(T &value)
+    {
+        return p_llist->pop_head(value);
+    }
+
     /**
      * @brief Peek value at top of stack.
      *
-     * @retval Value at top of stack.
+     * @retval Reference to value at top of stack.
      */
-    T peek()
+    T &peek()
     {
         assert(p_llist->p_head != NULL);
 
         return p_llist->p_head->value;
     }
 
+    /**
+     * @brief Make sure that at least a specific number of values can be
+     *        pushed without allocating memory from heap.
+     *
+     * @param[in] count: Number of values.
+     */
+    void reserve(int count)
+    {
+        p_llist->reserve(count);
+    }
+
     llist<T> *p_llist; ///< pointer to linked list
 };
 
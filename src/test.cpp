@@ -10,27 +10,152 @@
 #include <ctype.h>
 #include <time.h>
 
+#include <string>
+#include <thread>
+
 #include "llist.h"
 #include "dllist.h"
+#include "ullist.h"
 #include "stack.h"
+#include "cstack.h"
 #include "queue.h"
+#include "spscqueue.h"
+#include "mpmcqueue.h"
+#include "mpscqueue.h"
 #include "pqueue.h"
+#include "dpqueue.h"
+#include "ipqueue.h"
+#include "mpqueue.h"
+#include "ppqueue.h"
+#include "rpqueue.h"
 #include "btree.h"
+#include "eytzinger.h"
+#include "avltree.h"
+#include "bptree.h"
+#include "cbtree.h"
+#include "pbtree.h"
 
 #define RAND_VALUE_MAX 100 ///< maximum random value
 
+#define NUM_THREADS 4 ///< number of threads for concurrent tests
+
+/// value type counting it's copies & moves (containers should only move it)
+struct counted {
+    int value; ///< value
+
+    static int num_copies; ///< number of copies made (all instances)
+    static int num_moves;  ///< number of moves made (all instances)
+
+    /// constructor (explicit: emplace has to construct values directly)
+    explicit counted(int value = 0) : value(value) {}
+
+    /// constructor (two arguments, for emplace)
+    counted(int value_1, int value_2) : value(value_1 + value_2) {}
+
+    /// copy constructor
+    counted(const counted &other) : value(other.value) { num_copies++; }
+
+    /// move constructor
+    counted(counted &&other) : value(other.value) { num_moves++; }
+
+    /// copy assignment
+    counted &operator=(const counted &other)
+    {
+        value = other.value;
+
+        num_copies++;
+
+        return *this;
+    }
+
+    /// move assignment
+    counted &operator=(counted &&other)
+    {
+        value = other.value;
+
+        num_moves++;
+
+        return *this;
+    }
+
+    /// less than
+    bool operator<(const counted &other) const { return value < other.value; }
+
+    /// equality
+    bool operator==(const counted &other) const
+    {
+        return value == other.value;
+    }
+
+    /// reset counters
+    static void reset()
+    {
+        num_copies = 0;
+        num_moves  = 0;
+    }
+};
+
+int counted::num_copies = 0;
+int counted::num_moves  = 0;
+
+/// concurrent stack test value (a torn read shows as halves not matching)
+struct cstack_pair {
+    int value; ///< value
+    int check; ///< ~value
+};
+
 bool strings_are_equal(char *string1, const char *string2);
 
 void test_llist(int num_iterations);
 void test_dllist(int num_iterations);
+void test_ullist(int num_iterations);
 void test_stack(int num_iterations);
+void test_cstack(int num_iterations);
+void test_cstack_thread(cstack<int> *p_cstack, int num_iterations,
+                        long long *p_sum_pushed, long long *p_sum_popped);
+void test_cstack_pair_thread(cstack<cstack_pair> *p_cstack, int num_iterations,
+                             std::atomic<int> *p_num_running,
+                             std::atomic<int> *p_num_torn);
+void test_cstack_peek_thread(cstack<cstack_pair> *p_cstack,
+                             std::atomic<int> *p_num_running,
+                             std::atomic<int> *p_num_torn);
 void test_queue(int num_iterations);
+void test_spscqueue(int num_iterations);
+void test_mpmcqueue(int num_iterations);
+void test_mpscqueue(int num_iterations);
+void test_mpscqueue_producer(mpscqueue<int> *p_mpscqueue,
+                             llist_node<int> *p_nodes, int num_iterations,
+                             int id);
+void test_mpmcqueue_producer(mpmcqueue<int> *p_mpmcqueue, int num_iterations,
+                             long long *p_sum);
+void test_mpmcqueue_consumer(mpmcqueue<int> *p_mpmcqueue,
+                             std::atomic<int> *p_num_values, long long *p_sum);
+void test_spscqueue_thread(spscqueue<int> *p_spscqueue, int num_iterations);
 void test_pqueue(int num_iterations);
+void test_dpqueue(int num_iterations);
+void test_ipqueue(int num_iterations);
+void test_mpqueue(int num_iterations);
+void test_ppqueue(int num_iterations);
+void test_rpqueue(int num_iterations);
+void test_mpqueue_thread(mpqueue<int> *p_mpqueue, int num_iterations,
+                         long long *p_sum_enqueued, long long *p_sum_dequeued);
 void test_btree(int num_iterations);
+void test_btree_thread(btree<int> *p_btree, int num_iterations, int value_min,
+                       int *p_num_errors);
+void test_avltree(int num_iterations);
+void test_bptree(int num_iterations);
+void test_cbtree(int num_iterations);
+void test_pbtree(int num_iterations);
+void test_pbtree_thread(const pbtree<int> *p_snapshot, long long *p_sum);
+void test_cbtree_thread(cbtree<int> *p_cbtree, int num_iterations,
+                        int thread_index, int *p_num_keys, int *p_num_errors);
 
 void print_llist(llist_node<int> *p_node);
 void print_dllist(dllist_node<int> *p_node);
+void print_ullist(ullist_node<int> *p_node);
 void print_btree(btree_node<int> node);
+void print_avltree(avltree_node<int> node);
+void print_bptree(bptree_leaf<int> *p_leaf);
 
 char *get_basename(char *path);
 
@@ -40,7 +165,9 @@ char *get_basename(char *path);
 void print_usage(char **argv)
 {
     printf("Usage: %s [num iterations] "
-           "[llist|dllist|stack|queue|pqueue|btree]\n",
+           "[llist|dllist|ullist|stack|cstack|queue|spscqueue|mpmcqueue|"
+           "mpscqueue|pqueue|dpqueue|ipqueue|mpqueue|ppqueue|rpqueue|btree|"
+           "avltree|bptree|cbtree|pbtree]\n",
            get_basename(argv[0]));
 }
 
@@ -92,22 +219,78 @@ int main(int argc, char **argv)
             {
                 test_dllist(num_iterations);
             }
+            else if (strings_are_equal(argv[2], "ullist"))
+            {
+                test_ullist(num_iterations);
+            }
             else if (strings_are_equal(argv[2], "stack"))
             {
                 test_stack(num_iterations);
             }
+            else if (strings_are_equal(argv[2], "cstack"))
+            {
+                test_cstack(num_iterations);
+            }
             else if (strings_are_equal(argv[2], "queue"))
             {
                 test_queue(num_iterations);
             }
+            else if (strings_are_equal(argv[2], "spscqueue"))
+            {
+                test_spscqueue(num_iterations);
+            }
+            else if (strings_are_equal(argv[2], "mpmcqueue"))
+            {
+                test_mpmcqueue(num_iterations);
+            }
+            else if (strings_are_equal(argv[2], "mpscqueue"))
+            {
+                test_mpscqueue(num_iterations);
+            }
             else if (strings_are_equal(argv[2], "pqueue"))
             {
                 test_pqueue(num_iterations);
             }
+            else if (strings_are_equal(argv[2], "dpqueue"))
+            {
+                test_dpqueue(num_iterations);
+            }
+            else if (strings_are_equal(argv[2], "ipqueue"))
+            {
+                test_ipqueue(num_iterations);
+            }
+            else if (strings_are_equal(argv[2], "mpqueue"))
+            {
+                test_mpqueue(num_iterations);
+            }
+            else if (strings_are_equal(argv[2], "ppqueue"))
+            {
+                test_ppqueue(num_iterations);
+            }
+            else if (strings_are_equal(argv[2], "rpqueue"))
+            {
+                test_rpqueue(num_iterations);
+            }
             else if (strings_are_equal(argv[2], "btree"))
             {
                 test_btree(num_iterations);
             }
+            else if (strings_are_equal(argv[2], "avltree"))
+            {
+                test_avltree(num_iterations);
+            }
+            else if (strings_are_equal(argv[2], "bptree"))
+            {
+                test_bptree(num_iterations);
+            }
+            else if (strings_are_equal(argv[2], "cbtree"))
+            {
+                test_cbtree(num_iterations);
+            }
+            else if (strings_are_equal(argv[2], "pbtree"))
+            {
+                test_pbtree(num_iterations);
+            }
             else
             {
                 printf("!!! error: invalid selection '%s'\n", argv[2]);
@@ -131,9 +314,22 @@ void test_llist(int num_iterations)
 {
     llist<int> *p_llist;
 
+    llist<counted> *p_llist_counted;
+
+    llist<std::string> *p_llist_string;
+
+    counted value_counted;
+
+    std::string value_string;
+
     int rand_value, rand_index;
 
+    int values[RAND_VALUE_MAX + 1];
+
     int num_nodes = 0;
+    int num_probed;
+
+    int ii;
 
     p_llist = new llist<int>;
 
@@ -207,6 +403,47 @@ void test_llist(int num_iterations)
             print_llist(p_llist->p_head);
         }
 
+        if (num_nodes && (rand() % 2))
+        {
+            llist<int>::iterator it = p_llist->begin();
+
+            rand_index = rand() % num_nodes;
+
+            while (rand_index--)
+            {
+                ++it;
+            }
+
+            if (rand() % 2)
+            {
+                rand_value = rand() % (RAND_VALUE_MAX + 1);
+
+                printf("insert_after(%3d): %3d: ", *it, rand_value);
+
+                p_llist->insert_after(it.node(), rand_value);
+
+                num_nodes++;
+            }
+            else if (it.node()->p_next != NULL)
+            {
+                printf(" erase_after(%3d):      ", *it);
+
+                p_llist->erase_after(it.node());
+
+                num_nodes--;
+            }
+            else
+            {
+                printf(" erase_after(NULL):     ");
+
+                p_llist->erase_after(NULL);
+
+                num_nodes--;
+            }
+
+            print_llist(p_llist->p_head);
+        }
+
         if (num_nodes && rand() % 2)
         {
             if (rand() % 2)
@@ -229,6 +466,141 @@ void test_llist(int num_iterations)
     }
 
     delete p_llist;
+
+    // tail deletion (cached or walked predecessor) vs. array of values
+
+    p_llist = new llist<int>;
+
+    num_nodes = 0;
+
+    for (ii = 0; ii < RAND_VALUE_MAX * RAND_VALUE_MAX; ii++)
+    {
+        llist_node<int> *p_node;
+
+        rand_value = rand() % 4;
+
+        if ((num_nodes == 0) ||
+            ((num_nodes < RAND_VALUE_MAX) && (rand_value == 0)))
+        {
+            p_llist->add_tail(ii);
+
+            values[num_nodes++] = ii;
+        }
+        else if ((num_nodes < RAND_VALUE_MAX) && (rand_value == 1))
+        {
+            p_llist->add_head(ii);
+
+            memmove(&values[1], &values[0], num_nodes * sizeof(values[0]));
+
+            values[0] = ii;
+
+            num_nodes++;
+        }
+        else if (rand_value == 2)
+        {
+            p_llist->delete_tail();
+
+            num_nodes--;
+        }
+        else
+        {
+            // caller-supplied predecessor
+
+            p_node = NULL;
+
+            for (rand_index = 0; rand_index < num_nodes - 1; rand_index++)
+            {
+                p_node = (p_node == NULL) ? p_llist->p_head : p_node->p_next;
+            }
+
+            p_llist->delete_tail(p_node);
+
+            num_nodes--;
+        }
+
+        // add_tail relies on tail pointer: probe it (every other time, so
+        // that the probe's own delete_tail doesn't always reset the cached
+        // predecessor), then undo
+
+        num_probed = num_nodes;
+
+        if (ii % 2)
+        {
+            p_llist->add_tail(-1);
+
+            values[num_probed++] = -1;
+        }
+
+        p_node = p_llist->p_head;
+
+        for (rand_index = 0; rand_index < num_probed; rand_index++)
+        {
+            if ((p_node == NULL) || (p_node->value != values[rand_index]))
+            {
+                break;
+            }
+
+            p_node = p_node->p_next;
+        }
+
+        if ((rand_index != num_probed) || (p_node != NULL))
+        {
+            printf("!!! linked list inconsistent after tail deletion\n");
+            break;
+        }
+
+        if (ii % 2)
+        {
+            p_llist->delete_tail();
+        }
+    }
+
+    delete p_llist;
+
+    // values are constructed in place & moved, never copied
+
+    p_llist_counted = new llist<counted>;
+
+    counted::reset();
+
+    p_llist_counted->emplace_head(1);
+    p_llist_counted->emplace_tail(2, 3);
+    p_llist_counted->emplace_after(p_llist_counted->p_head, 4);
+
+    if (counted::num_moves != 0)
+    {
+        printf("!!! linked list emplace moved values\n");
+    }
+
+    p_llist_counted->add_head(counted(5));
+    p_llist_counted->add_tail(counted(6));
+    p_llist_counted->insert_after(p_llist_counted->p_head, counted(7));
+
+    while (p_llist_counted->pop_head(value_counted))
+    {
+    }
+
+    // 3 moves in, 6 moves out
+
+    if ((counted::num_copies != 0) || (counted::num_moves != 9) ||
+        (value_counted.value != 6))
+    {
+        printf("!!! linked list copied values\n");
+    }
+
+    delete p_llist_counted;
+
+    p_llist_string = new llist<std::string>;
+
+    p_llist_string->emplace_tail(3, 'x');
+
+    if ((p_llist_string->pop_head(value_string) == false) ||
+        (value_string != "xxx"))
+    {
+        printf("!!! linked list emplace incorrect\n");
+    }
+
+    delete p_llist_string;
 }
 
 /**
@@ -240,6 +612,10 @@ void test_dllist(int num_iterations)
 {
     dllist<int> *p_dllist;
 
+    dllist<counted> *p_dllist_counted;
+
+    counted value_counted;
+
     int rand_value;
 
     int num_nodes = 0;
@@ -312,72 +688,68 @@ void test_dllist(int num_iterations)
             print_dllist(p_dllist->p_head);
         }
     }
-}
 
-/**
- * @brief Test stack.
- *
- * @param[in] num_iterations: Number of iterations.
- */
-void test_stack(int num_iterations)
-{
-    stack<int> *p_stack;
+    delete p_dllist;
 
-    int rand_value;
+    // values are constructed in place & moved, never copied
 
-    int num_items = 0;
+    p_dllist_counted = new dllist<counted>;
 
-    p_stack = new stack<int>;
+    counted::reset();
 
-    srand(time(NULL));
+    p_dllist_counted->emplace_head(1);
+    p_dllist_counted->emplace_tail(2, 3);
 
-    while (num_iterations--)
+    if (counted::num_moves != 0)
     {
-        if (rand() % 2)
-        {
-            rand_value = rand() % (RAND_VALUE_MAX + 1);
-
-            printf("push(): %3d: ", rand_value);
-
-            p_stack->push(rand_value);
-
-            num_items++;
+        printf("!!! doubly-linked list emplace moved values\n");
+    }
 
-            print_llist(p_stack->p_llist->p_head);
-        }
+    p_dllist_counted->add_head(counted(4));
+    p_dllist_counted->add_tail(counted(6));
 
-        if (num_items && (rand() % 2))
-        {
-            printf(" pop(): %3d: ", p_stack->pop());
+    // 4 1 5 6: tail first, then head first
 
-            num_items--;
+    if ((p_dllist_counted->pop_tail(value_counted) == false) ||
+        (value_counted.value != 6) ||
+        (p_dllist_counted->pop_head(value_counted) == false) ||
+        (value_counted.value != 4))
+    {
+        printf("!!! doubly-linked list pop incorrect\n");
+    }
 
-            print_llist(p_stack->p_llist->p_head);
-        }
+    while (p_dllist_counted->pop_head(value_counted))
+    {
+    }
 
-        if (num_items && (rand() % 2))
-        {
-            printf("peek(): %3d: ", p_stack->peek());
+    // 2 moves in, 4 moves out
 
-            print_llist(p_stack->p_llist->p_head);
-        }
+    if ((counted::num_copies != 0) || (counted::num_moves != 6))
+    {
+        printf("!!! doubly-linked list copied values\n");
     }
 
-    delete p_stack;
+    delete p_dllist_counted;
 }
 
 /**
- * @brief Test queue.
+ * @brief Test unrolled linked list (against linked list).
  *
  * @param[in] num_iterations: Number of iterations.
  */
-void test_queue(int num_iterations)
+void test_ullist(int num_iterations)
 {
-    queue<int> *p_queue;
+    ullist<int> *p_ullist;
+
+    llist<int> *p_llist;
 
     int rand_value;
 
-    p_queue = new queue<int>;
+    int num_values = 0;
+
+    p_ullist = new ullist<int>;
+
+    p_llist = new llist<int>;
 
     srand(time(NULL));
 
@@ -387,138 +759,2668 @@ void test_queue(int num_iterations)
         {
             rand_value = rand() % (RAND_VALUE_MAX + 1);
 
-            printf("enqueue(): %3d: ", rand_value);
+            if (rand() % 2)
+            {
+                printf("   add_head(): %3d: ", rand_value);
 
-            p_queue->enqueue(rand_value);
+                p_ullist->add_head(rand_value);
 
-            print_llist(p_queue->p_llist->p_head);
-        }
+                p_llist->add_head(rand_value);
+            }
+            else
+            {
+                printf("   add_tail(): %3d: ", rand_value);
 
-        if ((p_queue->is_empty() == false) && (rand() % 2))
-        {
-            printf("dequeue(): %3d: ", p_queue->dequeue());
+                p_ullist->add_tail(rand_value);
 
-            print_llist(p_queue->p_llist->p_head);
-        }
-    }
+                p_llist->add_tail(rand_value);
+            }
 
-    delete p_queue;
-}
+            num_values++;
 
-/**
- * @brief Test priority queue.
- *
- * @param[in] num_iterations: Number of iterations.
- */
-void test_pqueue(int num_iterations)
-{
-    pqueue<int> *p_pqueue;
+            print_ullist(p_ullist->p_head);
+        }
 
-    int rand_value;
+        if (num_values && (rand() % 2))
+        {
+            llist_node<int> *p_node = p_llist->p_head;
 
-    p_pqueue = new pqueue<int>;
+            int rand_index = rand() % num_values;
 
-    srand(time(NULL));
+            while (rand_index--)
+            {
+                p_node = p_node->p_next;
+            }
+
+            rand_value = p_node->value;
+
+            printf("     remove(): %3d: ", rand_value);
+
+            if (p_ullist->find(rand_value) == NULL)
+            {
+                printf("!!! unrolled linked list inconsistent\n");
+                break;
+            }
+
+            p_ullist->remove(rand_value);
+
+            p_llist->remove(rand_value);
+
+            num_values--;
+
+            print_ullist(p_ullist->p_head);
+        }
+
+        if (num_values && (rand() % 2))
+        {
+            if (rand() % 2)
+            {
+                printf("delete_head():      ");
+
+                p_ullist->delete_head();
+
+                p_llist->delete_head();
+            }
+            else
+            {
+                printf("delete_tail():      ");
+
+                p_ullist->delete_tail();
+
+                p_llist->delete_tail();
+            }
+
+            num_values--;
+
+            print_ullist(p_ullist->p_head);
+        }
+
+        // both lists must hold the same values in the same order
+
+        ullist_node<int> *p_ullist_node = p_ullist->p_head;
+
+        llist_node<int> *p_llist_node = p_llist->p_head;
+
+        int index = 0;
+
+        while ((p_ullist_node != NULL) && (p_llist_node != NULL))
+        {
+            if (p_ullist_node->values[index] != p_llist_node->value)
+            {
+                break;
+            }
+
+            p_llist_node = p_llist_node->p_next;
+
+            if (++index == p_ullist_node->num_values)
+            {
+                p_ullist_node = p_ullist_node->p_next;
+
+                index = 0;
+            }
+        }
+
+        if ((p_ullist_node != NULL) || (p_llist_node != NULL))
+        {
+            printf("!!! unrolled linked list inconsistent\n");
+            break;
+        }
+    }
+
+    delete p_llist;
+
+    delete p_ullist;
+}
+
+/**
+ * @brief Test stack.
+ *
+ * @param[in] num_iterations: Number of iterations.
+ */
+void test_stack(int num_iterations)
+{
+    stack<int> *p_stack;
+
+    stack<counted> *p_stack_counted;
+
+    counted value_counted;
+
+    int rand_value;
+
+    int num_items = 0;
+
+    int capacity;
+
+    int ii;
+
+    p_stack = new stack<int>;
+
+    p_stack->reserve(num_iterations / 2);
+
+    // reserved nodes come from pool: pushing that many doesn't grow it
+
+    capacity = p_stack->p_llist->capacity();
+
+    for (ii = 0; ii < num_iterations / 2; ii++)
+    {
+        p_stack->push(ii);
+    }
+
+    printf("reserve(%d): capacity %d\n", num_iterations / 2, capacity);
+
+    if ((capacity < num_iterations / 2) ||
+        (p_stack->p_llist->capacity() != capacity))
+    {
+        printf("!!! stack allocated reserved nodes from heap\n");
+    }
+
+    while (p_stack->try_pop(rand_value))
+    {
+    }
+
+    srand(time(NULL));
+
+    while (num_iterations--)
+    {
+        if (rand() % 2)
+        {
+            rand_value = rand() % (RAND_VALUE_MAX + 1);
+
+            printf("push(): %3d: ", rand_value);
+
+            p_stack->push(rand_value);
+
+            num_items++;
+
+            print_llist(p_stack->p_llist->p_head);
+        }
+
+        if (num_items && (rand() % 2))
+        {
+            printf(" pop(): %3d: ", p_stack->pop());
+
+            num_items--;
+
+            print_llist(p_stack->p_llist->p_head);
+        }
+
+        if (num_items && (rand() % 2))
+        {
+            printf("peek(): %3d: ", p_stack->peek());
+
+            print_llist(p_stack->p_llist->p_head);
+        }
+
+        if (rand() % 2)
+        {
+            if (p_stack->try_pop(rand_value))
+            {
+                printf("try_pop(): %3d: ", rand_value);
+
+                num_items--;
+            }
+            else
+            {
+                printf("try_pop():      ");
+            }
+
+            print_llist(p_stack->p_llist->p_head);
+        }
+    }
+
+    delete p_stack;
+
+    // values are constructed in place & moved, never copied
+
+    p_stack_counted = new stack<counted>;
+
+    counted::reset();
+
+    p_stack_counted->emplace(1);
+    p_stack_counted->emplace(2, 3);
+
+    if (counted::num_moves != 0)
+    {
+        printf("!!! stack emplace moved values\n");
+    }
+
+    p_stack_counted->push(counted(4));
+
+    if (p_stack_counted->peek().value != 4)
+    {
+        printf("!!! stack peek incorrect\n");
+    }
+
+    while (p_stack_counted->try_pop(value_counted))
+    {
+    }
+
+    // 1 move in, 3 moves out
+
+    if ((counted::num_copies != 0) || (counted::num_moves != 4) ||
+        (value_counted.value != 1))
+    {
+        printf("!!! stack copied values\n");
+    }
+
+    p_stack_counted->emplace(7);
+
+    if ((p_stack_counted->pop().value != 7) || (counted::num_copies != 0))
+    {
+        printf("!!! stack copied values\n");
+    }
+
+    delete p_stack_counted;
+}
+
+/**
+ * @brief Concurrent stack test thread: push & pop values, adding up pushed &
+ *        popped values.
+ *
+ * @param[in,out] p_cstack:       Pointer to concurrent stack.
+ * @param[in]     num_iterations: Number of iterations.
+ * @param[out]    p_sum_pushed:   Pointer to sum of pushed values.
+ * @param[out]    p_sum_popped:   Pointer to sum of popped values.
+ */
+void test_cstack_thread(cstack<int> *p_cstack, int num_iterations,
+                        long long *p_sum_pushed, long long *p_sum_popped)
+{
+    int value;
+
+    int ii;
+
+    for (ii = 0; ii < num_iterations; ii++)
+    {
+        p_cstack->push(ii);
+
+        *p_sum_pushed += ii;
+
+        if ((ii % 2) && p_cstack->try_pop(value))
+        {
+            *p_sum_popped += value;
+        }
+
+        if ((ii % 4) && p_cstack->try_pop(value))
+        {
+            *p_sum_popped += value;
+        }
+    }
+}
+
+/**
+ * @brief Concurrent stack test thread: push & pop pairs whose halves match,
+ *        counting popped pairs whose halves don't.
+ *
+ * @param[in,out] p_cstack:       Pointer to concurrent stack.
+ * @param[in]     num_iterations: Number of iterations.
+ * @param[in,out] p_num_running:  Pointer to number of running push threads.
+ * @param[in,out] p_num_torn:     Pointer to number of torn values.
+ */
+void test_cstack_pair_thread(cstack<cstack_pair> *p_cstack, int num_iterations,
+                             std::atomic<int> *p_num_running,
+                             std::atomic<int> *p_num_torn)
+{
+    cstack_pair pair;
+
+    int ii;
+
+    for (ii = 0; ii < num_iterations; ii++)
+    {
+        p_cstack->push(cstack_pair{ii, ~ii});
+
+        if (p_cstack->try_pop(pair) && (pair.check != ~pair.value))
+        {
+            (*p_num_torn)++;
+        }
+
+        if ((ii % 2) && p_cstack->try_pop(pair) &&
+            (pair.check != ~pair.value))
+        {
+            (*p_num_torn)++;
+        }
+    }
+
+    (*p_num_running)--;
+}
+
+/**
+ * @brief Concurrent stack test thread: peek while push threads run,
+ *        counting peeked pairs whose halves don't match.
+ *
+ * @param[in,out] p_cstack:      Pointer to concurrent stack.
+ * @param[in,out] p_num_running: Pointer to number of running push threads.
+ * @param[in,out] p_num_torn:    Pointer to number of torn values.
+ */
+void test_cstack_peek_thread(cstack<cstack_pair> *p_cstack,
+                             std::atomic<int> *p_num_running,
+                             std::atomic<int> *p_num_torn)
+{
+    cstack_pair pair;
+
+    while (p_num_running->load() > 0)
+    {
+        if (p_cstack->try_peek(pair) && (pair.check != ~pair.value))
+        {
+            (*p_num_torn)++;
+        }
+    }
+}
+
+/**
+ * @brief Test concurrent stack.
+ *
+ * @param[in] num_iterations: Number of iterations (per thread).
+ */
+void test_cstack(int num_iterations)
+{
+    cstack<int> *p_cstack;
+
+    cstack<cstack_pair> *p_cstack_pair;
+
+    std::atomic<int> num_running(NUM_THREADS / 2);
+    std::atomic<int> num_torn(0);
+
+    std::thread threads[NUM_THREADS];
+
+    long long sum_pushed[NUM_THREADS] = { 0 };
+    long long sum_popped[NUM_THREADS] = { 0 };
+
+    long long sum_pushed_total = 0;
+    long long sum_popped_total = 0;
+
+    int value;
+
+    int ii;
+
+    p_cstack = new cstack<int>;
+
+    for (ii = 0; ii < NUM_THREADS; ii++)
+    {
+        threads[ii] = std::thread(test_cstack_thread, p_cstack, num_iterations,
+                                  &sum_pushed[ii], &sum_popped[ii]);
+    }
+
+    for (ii = 0; ii < NUM_THREADS; ii++)
+    {
+        threads[ii].join();
+
+        printf("thread %d: pushed %lld, popped %lld\n", ii, sum_pushed[ii],
+               sum_popped[ii]);
+
+        sum_pushed_total += sum_pushed[ii];
+        sum_popped_total += sum_popped[ii];
+    }
+
+    if (p_cstack->is_empty() == false)
+    {
+        printf("peek(): %3d\n", p_cstack->peek());
+    }
+
+    while (p_cstack->try_pop(value))
+    {
+        sum_popped_total += value;
+    }
+
+    printf("total:    pushed %lld, popped %lld\n", sum_pushed_total,
+           sum_popped_total);
+
+    if (sum_pushed_total != sum_popped_total)
+    {
+        printf("!!! concurrent stack inconsistent\n");
+    }
+
+    delete p_cstack;
+
+    // peeks racing pushes & pops (which recycle nodes) only see whole values
+
+    p_cstack_pair = new cstack<cstack_pair>;
+
+    for (ii = 0; ii < NUM_THREADS; ii++)
+    {
+        if (ii % 2)
+        {
+            threads[ii] = std::thread(test_cstack_pair_thread, p_cstack_pair,
+                                      num_iterations, &num_running,
+                                      &num_torn);
+        }
+        else
+        {
+            threads[ii] = std::thread(test_cstack_peek_thread, p_cstack_pair,
+                                      &num_running, &num_torn);
+        }
+    }
+
+    for (ii = 0; ii < NUM_THREADS; ii++)
+    {
+        threads[ii].join();
+    }
+
+    printf("peek() racing push()/pop(): %d torn values\n", num_torn.load());
+
+    if (num_torn.load() != 0)
+    {
+        printf("!!! concurrent stack peek inconsistent\n");
+    }
+
+    delete p_cstack_pair;
+}
+
+/**
+ * @brief Test queue.
+ *
+ * @param[in] num_iterations: Number of iterations.
+ */
+void test_queue(int num_iterations)
+{
+    queue<int> *p_queue;
+
+    queue<counted> *p_queue_counted;
+
+    counted value_counted;
+
+    int rand_value;
+
+    int capacity;
+
+    int ii;
+
+    p_queue = new queue<int>;
+
+    p_queue->reserve(num_iterations / 2);
+
+    // reserved nodes come from pool: enqueueing that many doesn't grow it
+
+    capacity = p_queue->p_llist->capacity();
+
+    for (ii = 0; ii < num_iterations / 2; ii++)
+    {
+        p_queue->enqueue(ii);
+    }
+
+    printf("reserve(%d): capacity %d\n", num_iterations / 2, capacity);
+
+    if ((capacity < num_iterations / 2) ||
+        (p_queue->p_llist->capacity() != capacity))
+    {
+        printf("!!! queue allocated reserved nodes from heap\n");
+    }
+
+    while (p_queue->try_dequeue(rand_value))
+    {
+    }
+
+    srand(time(NULL));
+
+    while (num_iterations--)
+    {
+        if (rand() % 2)
+        {
+            rand_value = rand() % (RAND_VALUE_MAX + 1);
+
+            printf("enqueue(): %3d: ", rand_value);
+
+            p_queue->enqueue(rand_value);
+
+            print_llist(p_queue->p_llist->p_head);
+        }
+
+        if ((p_queue->is_empty() == false) && (rand() % 2))
+        {
+            printf("dequeue(): %3d: ", p_queue->dequeue());
+
+            print_llist(p_queue->p_llist->p_head);
+        }
+
+        if (rand() % 2)
+        {
+            if (p_queue->try_dequeue(rand_value))
+            {
+                printf("try_dequeue(): %3d: ", rand_value);
+            }
+            else
+            {
+                printf("try_dequeue():      ");
+            }
+
+            print_llist(p_queue->p_llist->p_head);
+        }
+    }
+
+    delete p_queue;
+
+    // values are constructed in place & moved, never copied
+
+    p_queue_counted = new queue<counted>;
+
+    counted::reset();
+
+    p_queue_counted->emplace(1);
+    p_queue_counted->emplace(2, 3);
+
+    if (counted::num_moves != 0)
+    {
+        printf("!!! queue emplace moved values\n");
+    }
+
+    p_queue_counted->enqueue(counted(4));
+
+    while (p_queue_counted->try_dequeue(value_counted))
+    {
+    }
+
+    // 1 move in, 3 moves out
+
+    if ((counted::num_copies != 0) || (counted::num_moves != 4) ||
+        (value_counted.value != 4))
+    {
+        printf("!!! queue copied values\n");
+    }
+
+    p_queue_counted->emplace(7);
+
+    if ((p_queue_counted->dequeue().value != 7) || (counted::num_copies != 0))
+    {
+        printf("!!! queue copied values\n");
+    }
+
+    delete p_queue_counted;
+}
+
+/**
+ * @brief Single-producer/single-consumer queue test producer thread: enqueue
+ *        0, 1, 2, ... (retrying while queue is full).
+ *
+ * @param[in,out] p_spscqueue:    Pointer to single-producer/single-consumer
+ *                                queue.
+ * @param[in]     num_iterations: Number of values to enqueue.
+ */
+void test_spscqueue_thread(spscqueue<int> *p_spscqueue, int num_iterations)
+{
+    int ii;
+
+    for (ii = 0; ii < num_iterations; ii++)
+    {
+        while (p_spscqueue->enqueue(ii) == false)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+/**
+ * @brief Test single-producer/single-consumer queue (values must be dequeued
+ *        in the order they were enqueued).
+ *
+ * @param[in] num_iterations: Number of iterations.
+ */
+void test_spscqueue(int num_iterations)
+{
+    spscqueue<int> *p_spscqueue;
+
+    std::thread producer;
+
+    int value;
+
+    int num_dequeued = 0;
+
+    p_spscqueue = new spscqueue<int>(RAND_VALUE_MAX);
+
+    producer = std::thread(test_spscqueue_thread, p_spscqueue, num_iterations);
+
+    while (num_dequeued < num_iterations)
+    {
+        if (p_spscqueue->try_dequeue(value) == false)
+        {
+            std::this_thread::yield();
+        }
+        else if (value != num_dequeued++)
+        {
+            printf("!!! queue out of order: dequeued %d, expected %d\n",
+                   value, num_dequeued - 1);
+            break;
+        }
+    }
+
+    producer.join();
+
+    printf("dequeued %d of %d values\n", num_dequeued, num_iterations);
+
+    if (p_spscqueue->is_empty() == false)
+    {
+        printf("!!! queue not empty\n");
+    }
+
+    delete p_spscqueue;
+}
+
+/**
+ * @brief Multi-producer/multi-consumer queue test producer thread: enqueue
+ *        values one at a time & in bulk, adding them up.
+ *
+ * @param[in,out] p_mpmcqueue:    Pointer to multi-producer/multi-consumer
+ *                                queue.
+ * @param[in]     num_iterations: Number of values to enqueue.
+ * @param[out]    p_sum:          Pointer to sum of enqueued values.
+ */
+void test_mpmcqueue_producer(mpmcqueue<int> *p_mpmcqueue, int num_iterations,
+                             long long *p_sum)
+{
+    int values[8];
+
+    int num_values;
+    int ii;
+
+    for (ii = 0; ii < num_iterations; ii += num_values)
+    {
+        num_values = (num_iterations - ii < 8) ? (num_iterations - ii) : 8;
+
+        if (ii % 2)
+        {
+            p_mpmcqueue->enqueue(ii);
+
+            *p_sum += ii;
+
+            num_values = 1;
+        }
+        else
+        {
+            int jj;
+
+            for (jj = 0; jj < num_values; jj++)
+            {
+                values[jj] = ii + jj;
+
+                *p_sum += ii + jj;
+            }
+
+            jj = 0;
+
+            while (jj < num_values)
+            {
+                jj += p_mpmcqueue->try_enqueue_bulk(&values[jj],
+                                                    num_values - jj);
+
+                if (jj < num_values)
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Multi-producer/multi-consumer queue test consumer thread: dequeue
+ *        values one at a time & in bulk until all values have been dequeued,
+ *        adding them up.
+ *
+ * @param[in,out] p_mpmcqueue:  Pointer to multi-producer/multi-consumer queue.
+ * @param[in,out] p_num_values: Pointer to number of values left to dequeue
+ *                              (shared by all consumers).
+ * @param[out]    p_sum:        Pointer to sum of dequeued values.
+ */
+void test_mpmcqueue_consumer(mpmcqueue<int> *p_mpmcqueue,
+                             std::atomic<int> *p_num_values, long long *p_sum)
+{
+    int values[8];
+
+    int num_values;
+    int ii;
+
+    while (p_num_values->load() > 0)
+    {
+        if (p_num_values->load() % 2)
+        {
+            num_values = p_mpmcqueue->try_dequeue(values[0]) ? 1 : 0;
+        }
+        else
+        {
+            num_values = p_mpmcqueue->try_dequeue_bulk(values, 8);
+        }
+
+        if (num_values == 0)
+        {
+            std::this_thread::yield();
+        }
+
+        for (ii = 0; ii < num_values; ii++)
+        {
+            *p_sum += values[ii];
+        }
+
+        *p_num_values -= num_values;
+    }
+}
+
+/**
+ * @brief Test multi-producer/multi-consumer queue.
+ *
+ * @param[in] num_iterations: Number of iterations (per producer).
+ */
+void test_mpmcqueue(int num_iterations)
+{
+    mpmcqueue<int> *p_mpmcqueue;
+
+    std::thread producers[NUM_THREADS / 2];
+    std::thread consumers[NUM_THREADS / 2];
+
+    long long sum_enqueued[NUM_THREADS / 2] = { 0 };
+    long long sum_dequeued[NUM_THREADS / 2] = { 0 };
+
+    long long sum_enqueued_total = 0;
+    long long sum_dequeued_total = 0;
+
+    std::atomic<int> num_values(num_iterations * (NUM_THREADS / 2));
+
+    int ii;
+
+    p_mpmcqueue = new mpmcqueue<int>(RAND_VALUE_MAX);
+
+    for (ii = 0; ii < NUM_THREADS / 2; ii++)
+    {
+        producers[ii] = std::thread(test_mpmcqueue_producer, p_mpmcqueue,
+                                    num_iterations, &sum_enqueued[ii]);
+
+        consumers[ii] = std::thread(test_mpmcqueue_consumer, p_mpmcqueue,
+                                    &num_values, &sum_dequeued[ii]);
+    }
+
+    for (ii = 0; ii < NUM_THREADS / 2; ii++)
+    {
+        producers[ii].join();
+        consumers[ii].join();
+
+        printf("producer %d: enqueued %lld\n", ii, sum_enqueued[ii]);
+        printf("consumer %d: dequeued %lld\n", ii, sum_dequeued[ii]);
+
+        sum_enqueued_total += sum_enqueued[ii];
+        sum_dequeued_total += sum_dequeued[ii];
+    }
+
+    printf("total:      enqueued %lld, dequeued %lld\n", sum_enqueued_total,
+           sum_dequeued_total);
+
+    if ((sum_enqueued_total != sum_dequeued_total) ||
+        (p_mpmcqueue->is_empty() == false))
+    {
+        printf("!!! multi-producer/multi-consumer queue inconsistent\n");
+    }
+
+    delete p_mpmcqueue;
+}
+
+/**
+ * @brief Multi-producer/single-consumer queue test producer thread: enqueue
+ *        preallocated nodes with values id, id + NUM_THREADS, ...
+ *
+ * @param[in,out] p_mpscqueue:    Pointer to multi-producer/single-consumer
+ *                                queue.
+ * @param[in,out] p_nodes:        Pointer to preallocated nodes.
+ * @param[in]     num_iterations: Number of nodes.
+ * @param[in]     id:             Producer ID.
+ */
+void test_mpscqueue_producer(mpscqueue<int> *p_mpscqueue,
+                             llist_node<int> *p_nodes, int num_iterations,
+                             int id)
+{
+    int ii;
+
+    for (ii = 0; ii < num_iterations; ii++)
+    {
+        p_nodes[ii].value = (ii * NUM_THREADS) + id;
+
+        p_mpscqueue->enqueue(&p_nodes[ii]);
+    }
+}
+
+/**
+ * @brief Test multi-producer/single-consumer queue (each producer's values
+ *        must be dequeued in the order they were enqueued).
+ *
+ * @param[in] num_iterations: Number of iterations (per producer).
+ */
+void test_mpscqueue(int num_iterations)
+{
+    mpscqueue<int> *p_mpscqueue;
+
+    llist_node<int> *p_nodes;
+    llist_node<int> *p_node;
+
+    std::thread producers[NUM_THREADS];
+
+    int expected[NUM_THREADS];
+
+    int num_dequeued = 0;
+
+    int value;
+
+    int ii;
+
+    p_mpscqueue = new mpscqueue<int>;
+
+    p_nodes = new llist_node<int>[num_iterations * NUM_THREADS];
+
+    // single-threaded: queue owns nodes
+
+    for (ii = 0; ii < RAND_VALUE_MAX; ii++)
+    {
+        p_mpscqueue->enqueue(ii);
+    }
+
+    while (p_mpscqueue->try_dequeue(value))
+    {
+        if (value != num_dequeued++)
+        {
+            printf("!!! queue out of order: dequeued %d, expected %d\n",
+                   value, num_dequeued - 1);
+        }
+    }
+
+    // multi-threaded: producers own (preallocated) nodes
+
+    for (ii = 0; ii < NUM_THREADS; ii++)
+    {
+        expected[ii] = ii;
+
+        producers[ii] = std::thread(test_mpscqueue_producer, p_mpscqueue,
+                                    &p_nodes[ii * num_iterations],
+                                    num_iterations, ii);
+    }
+
+    num_dequeued = 0;
+
+    while (num_dequeued < num_iterations * NUM_THREADS)
+    {
+        p_node = p_mpscqueue->dequeue_node();
+
+        if (p_node == NULL)
+        {
+            std::this_thread::yield();
+        }
+        else if (p_node->value != expected[p_node->value % NUM_THREADS])
+        {
+            printf("!!! queue out of order: dequeued %d, expected %d\n",
+                   p_node->value, expected[p_node->value % NUM_THREADS]);
+            break;
+        }
+        else
+        {
+            expected[p_node->value % NUM_THREADS] += NUM_THREADS;
+
+            num_dequeued++;
+        }
+    }
+
+    for (ii = 0; ii < NUM_THREADS; ii++)
+    {
+        producers[ii].join();
+    }
+
+    printf("dequeued %d of %d values\n", num_dequeued,
+           num_iterations * NUM_THREADS);
+
+    if (p_mpscqueue->is_empty() == false)
+    {
+        printf("!!! queue not empty\n");
+    }
+
+    delete p_mpscqueue;
+
+    delete [] p_nodes;
+}
+
+/**
+ * @brief Test priority queue.
+ *
+ * @param[in] num_iterations: Number of iterations.
+ */
+void test_pqueue(int num_iterations)
+{
+    pqueue<int> *p_pqueue;
+
+    pqueue<counted> *p_pqueue_counted;
+
+    counted value_counted;
+
+    int rand_value;
+
+    p_pqueue = new pqueue<int>;
+
+    srand(time(NULL));
+
+    while (num_iterations--)
+    {
+        if (rand() % 2)
+        {
+            rand_value = rand() % (RAND_VALUE_MAX + 1);
+
+            printf("enqueue(): %3d: ", rand_value);
+
+            p_pqueue->enqueue(rand_value);
+
+            print_llist(p_pqueue->p_llist->p_head);
+        }
+
+        if ((p_pqueue->is_empty() == false) && (rand() % 2))
+        {
+            printf("dequeue(): %3d: ", p_pqueue->dequeue());
+
+            print_llist(p_pqueue->p_llist->p_head);
+        }
+    }
+
+    delete p_pqueue;
+
+    // values are moved, never copied (emplace moves once: a value has to
+    // exist before it's position can be found)
+
+    p_pqueue_counted = new pqueue<counted>;
+
+    counted::reset();
+
+    p_pqueue_counted->enqueue(counted(3));
+    p_pqueue_counted->emplace(1);
+    p_pqueue_counted->emplace(2, 3);
+
+    if ((p_pqueue_counted->dequeue().value != 1) ||
+        (p_pqueue_counted->try_dequeue(value_counted) == false) ||
+        (value_counted.value != 3) ||
+        (p_pqueue_counted->try_dequeue(value_counted) == false) ||
+        (value_counted.value != 5) ||
+        p_pqueue_counted->try_dequeue(value_counted))
+    {
+        printf("!!! priority queue order incorrect\n");
+    }
+
+    if (counted::num_copies != 0)
+    {
+        printf("!!! priority queue copied values\n");
+    }
+
+    delete p_pqueue_counted;
+}
+
+/**
+ * @brief Test d-ary heap priority queue (against priority queue).
+ *
+ * @param[in] num_iterations: Number of iterations.
+ */
+void test_dpqueue(int num_iterations)
+{
+    dpqueue<int, 8> *p_dpqueue;
+
+    dpqueue<std::string, 8> *p_dpqueue_string;
+
+    pqueue<int> *p_pqueue;
+
+    int rand_value;
+
+    int value_prev = 0;
+
+    int ii;
+
+    p_dpqueue = new dpqueue<int, 8>;
+
+    p_pqueue = new pqueue<int>;
+
+    srand(time(NULL));
+
+    while (num_iterations--)
+    {
+        if (rand() % 2)
+        {
+            rand_value = rand() % (RAND_VALUE_MAX + 1);
+
+            printf("enqueue(): %3d: ", rand_value);
+
+            p_dpqueue->enqueue(rand_value);
+
+            p_pqueue->enqueue(rand_value);
+        }
+        else if (p_dpqueue->is_empty() == false)
+        {
+            rand_value = p_dpqueue->dequeue();
+
+            printf("dequeue(): %3d: ", rand_value);
+
+            if (rand_value != p_pqueue->dequeue())
+            {
+                printf("!!! d-ary heap out of order\n");
+                break;
+            }
+        }
+        else
+        {
+            continue;
+        }
+
+        for (ii = 0; ii < p_dpqueue->size(); ii++)
+        {
+            printf("%4d", p_dpqueue->p_items[ii]);
+        }
+
+        printf("\n");
+
+        if (p_dpqueue->verify() == false)
+        {
+            printf("!!! d-ary heap inconsistent\n");
+            break;
+        }
+    }
+
+    // children of node i start at D * i + 1: every group of 8 ints lies in
+    // one cache line if item 1 starts one
+
+    p_dpqueue->enqueue(0);
+
+    if ((uintptr_t)&p_dpqueue->p_items[1] % DPQUEUE_CACHE_LINE_SIZE != 0)
+    {
+        printf("!!! d-ary heap child groups not cache line aligned\n");
+    }
+
+    delete p_pqueue;
+
+    delete p_dpqueue;
+
+    // non-trivial items (constructed & destroyed in aligned array)
+
+    p_dpqueue_string = new dpqueue<std::string, 8>;
+
+    for (ii = 0; ii < 2 * DPQUEUE_CAPACITY_MIN; ii++)
+    {
+        p_dpqueue_string->emplace(1, (char)('a' + (ii * 7) % 26));
+    }
+
+    for (ii = 0; ii < DPQUEUE_CAPACITY_MIN; ii++)
+    {
+        rand_value = p_dpqueue_string->dequeue()[0];
+
+        if ((ii > 0) && (rand_value < value_prev))
+        {
+            printf("!!! d-ary heap of strings out of order\n");
+            break;
+        }
+
+        value_prev = rand_value;
+    }
+
+    delete p_dpqueue_string;
+}
+
+/**
+ * @brief Test indexed priority queue.
+ *
+ * @param[in] num_iterations: Number of iterations.
+ */
+void test_ipqueue(int num_iterations)
+{
+    ipqueue<int> *p_ipqueue;
+
+    ipqueue_handle *p_handles; // handles of queued items (in no order)
+
+    ipqueue_handle handle;
+    ipqueue_handle handle_stale = -1; // last dequeued / erased item's
+
+    int num_handles = 0;
+
+    int rand_value, rand_index;
+
+    int ii;
+
+    p_ipqueue = new ipqueue<int>;
+
+    p_handles = new ipqueue_handle[num_iterations + 1];
+
+    srand(time(NULL));
+
+    while (num_iterations--)
+    {
+        switch (rand() % 4)
+        {
+        case 0:
+            rand_value = rand() % (RAND_VALUE_MAX + 1);
+
+            handle = p_ipqueue->enqueue(rand_value);
+
+            printf("    enqueue(%3d): [%2d] ", rand_value, (int)handle);
+
+            p_handles[num_handles++] = handle;
+
+            // item may reuse stale handle's slot, but not it's handle
+
+            if ((handle == handle_stale) || p_ipqueue->contains(handle_stale))
+            {
+                printf("!!! stale handle refers to new item\n");
+            }
+
+            break;
+
+        case 1:
+            if (num_handles == 0)
+            {
+                continue;
+            }
+
+            handle = p_ipqueue->peek_handle();
+
+            rand_value = p_ipqueue->dequeue();
+
+            printf("      dequeue(): [%2d] %3d: ", (int)handle, rand_value);
+
+            handle_stale = handle;
+
+            for (ii = 0; p_handles[ii] != handle; ii++)
+            {
+            }
+
+            p_handles[ii] = p_handles[--num_handles];
+
+            break;
+
+        case 2:
+            if (num_handles == 0)
+            {
+                continue;
+            }
+
+            rand_index = rand() % num_handles;
+            rand_value = rand() % (RAND_VALUE_MAX + 1);
+
+            handle = p_handles[rand_index];
+
+            printf("update([%2d], %3d): %3d: ", (int)handle, rand_value,
+                   p_ipqueue->value(handle));
+
+            p_ipqueue->update(handle, rand_value);
+
+            break;
+
+        default:
+            if (num_handles == 0)
+            {
+                continue;
+            }
+
+            rand_index = rand() % num_handles;
+
+            handle = p_handles[rand_index];
+
+            printf("     erase([%2d]): %3d: ", (int)handle,
+                   p_ipqueue->value(handle));
+
+            p_ipqueue->erase(handle);
+
+            handle_stale = handle;
+
+            p_handles[rand_index] = p_handles[--num_handles];
+
+            break;
+        }
+
+        for (ii = 0; ii < num_handles; ii++)
+        {
+            printf("%4d", p_ipqueue->value(p_handles[ii]));
+        }
+
+        printf("\n");
+
+        if ((p_ipqueue->size() != num_handles) ||
+            (p_ipqueue->verify() == false))
+        {
+            printf("!!! indexed priority queue inconsistent\n");
+            break;
+        }
+    }
+
+    delete [] p_handles;
+
+    delete p_ipqueue;
+}
+
+/**
+ * @brief Concurrent priority queue test thread: enqueue random values and
+ *        dequeue about as many.
+ *
+ * @param[in,out] p_mpqueue:      Pointer to concurrent priority queue.
+ * @param[in]     num_iterations: Number of iterations.
+ * @param[out]    p_sum_enqueued: Pointer to sum of enqueued values.
+ * @param[out]    p_sum_dequeued: Pointer to sum of dequeued values.
+ */
+void test_mpqueue_thread(mpqueue<int> *p_mpqueue, int num_iterations,
+                         long long *p_sum_enqueued, long long *p_sum_dequeued)
+{
+    unsigned int seed = (unsigned int)(uintptr_t)p_sum_enqueued;
+
+    int value;
+
+    while (num_iterations--)
+    {
+        if (rand_r(&seed) % 2)
+        {
+            value = rand_r(&seed) % (RAND_VALUE_MAX + 1);
+
+            p_mpqueue->enqueue(value);
+
+            *p_sum_enqueued += value;
+        }
+        else if (p_mpqueue->try_dequeue(value))
+        {
+            *p_sum_dequeued += value;
+        }
+    }
+}
+
+/**
+ * @brief Test concurrent priority queue.
+ *
+ * @param[in] num_iterations: Number of iterations (per thread).
+ */
+void test_mpqueue(int num_iterations)
+{
+    mpqueue<int> *p_mpqueue;
+
+    pqueue<int> *p_pqueue;
+
+    std::thread threads[NUM_THREADS];
+
+    long long sum_enqueued[NUM_THREADS] = { 0 };
+    long long sum_dequeued[NUM_THREADS] = { 0 };
+
+    long long sum_enqueued_total = 0;
+    long long sum_dequeued_total = 0;
+
+    int rand_value;
+
+    int ii;
+
+    // single shard: exact priority order
+
+    p_mpqueue = new mpqueue<int>(1, 1);
+
+    p_pqueue = new pqueue<int>;
+
+    srand(time(NULL));
+
+    for (ii = 0; ii < num_iterations; ii++)
+    {
+        if (rand() % 2)
+        {
+            rand_value = rand() % (RAND_VALUE_MAX + 1);
+
+            printf("enqueue(): %3d\n", rand_value);
+
+            p_mpqueue->enqueue(rand_value);
+
+            p_pqueue->enqueue(rand_value);
+        }
+        else if (p_mpqueue->try_dequeue(rand_value))
+        {
+            printf("dequeue(): %3d\n", rand_value);
+
+            if (rand_value != p_pqueue->dequeue())
+            {
+                printf("!!! priority queue out of order\n");
+                break;
+            }
+        }
+        else if (p_pqueue->is_empty() == false)
+        {
+            printf("!!! priority queue lost value\n");
+            break;
+        }
+    }
+
+    delete p_pqueue;
+
+    delete p_mpqueue;
+
+    // sharded: relaxed order, but nothing lost
+
+    p_mpqueue = new mpqueue<int>(NUM_THREADS);
+
+    for (ii = 0; ii < NUM_THREADS; ii++)
+    {
+        threads[ii] = std::thread(test_mpqueue_thread, p_mpqueue,
+                                  num_iterations, &sum_enqueued[ii],
+                                  &sum_dequeued[ii]);
+    }
+
+    for (ii = 0; ii < NUM_THREADS; ii++)
+    {
+        threads[ii].join();
+
+        printf("thread %d: enqueued %lld, dequeued %lld\n", ii,
+               sum_enqueued[ii], sum_dequeued[ii]);
+
+        sum_enqueued_total += sum_enqueued[ii];
+        sum_dequeued_total += sum_dequeued[ii];
+    }
+
+    while (p_mpqueue->try_dequeue(rand_value))
+    {
+        sum_dequeued_total += rand_value;
+    }
+
+    printf("total:    enqueued %lld, dequeued %lld\n", sum_enqueued_total,
+           sum_dequeued_total);
+
+    if ((sum_enqueued_total != sum_dequeued_total) ||
+        (p_mpqueue->is_empty() == false))
+    {
+        printf("!!! concurrent priority queue inconsistent\n");
+    }
+
+    delete p_mpqueue;
+}
+
+/**
+ * @brief Test meldable priority queue.
+ *
+ * @param[in] num_iterations: Number of iterations.
+ */
+void test_ppqueue(int num_iterations)
+{
+    ppqueue<int> *p_ppqueue;
+    ppqueue<int> *p_other;
+
+    pqueue<int> *p_pqueue;
+
+    int rand_value, choice;
+
+    int ii;
+
+    p_ppqueue = new ppqueue<int>;
+
+    p_pqueue = new pqueue<int>;
+
+    srand(time(NULL));
+
+    while (num_iterations--)
+    {
+        choice = rand() % 3;
+
+        if (choice == 0)
+        {
+            rand_value = rand() % (RAND_VALUE_MAX + 1);
+
+            printf("enqueue(): %3d: ", rand_value);
+
+            p_ppqueue->enqueue(rand_value);
+
+            p_pqueue->enqueue(rand_value);
+        }
+        else if ((choice == 1) && (p_ppqueue->is_empty() == false))
+        {
+            rand_value = p_ppqueue->dequeue();
+
+            printf("dequeue(): %3d: ", rand_value);
+
+            if (rand_value != p_pqueue->dequeue())
+            {
+                printf("!!! pairing heap out of order\n");
+                break;
+            }
+        }
+        else if (choice == 2)
+        {
+            p_other = new ppqueue<int>;
+
+            printf("   meld():");
+
+            for (ii = rand() % 4; ii > 0; ii--)
+            {
+                rand_value = rand() % (RAND_VALUE_MAX + 1);
+
+                printf(" %3d", rand_value);
+
+                p_other->enqueue(rand_value);
+
+                p_pqueue->enqueue(rand_value);
+            }
+
+            printf(": ");
+
+            p_ppqueue->meld(*p_other);
+
+            if (p_other->is_empty() == false)
+            {
+                printf("!!! melded queue not empty\n");
+            }
+
+            delete p_other;
+        }
+        else
+        {
+            continue;
+        }
+
+        if (p_ppqueue->is_empty() == false)
+        {
+            printf("[%3d] ", p_ppqueue->peek());
+        }
+
+        printf("%d\n", p_ppqueue->size());
+
+        if (p_ppqueue->verify() == false)
+        {
+            printf("!!! pairing heap inconsistent\n");
+            break;
+        }
+    }
+
+    delete p_pqueue;
+
+    delete p_ppqueue;
+}
+
+/**
+ * @brief Test monotone priority queue (keys never below last dequeued key).
+ *
+ * @param[in] num_iterations: Number of iterations.
+ */
+void test_rpqueue(int num_iterations)
+{
+    rpqueue<int> *p_rpqueue;
+
+    pqueue<int> *p_pqueue;
+
+    int rand_value;
+
+    int last = -RAND_VALUE_MAX;
+
+    p_rpqueue = new rpqueue<int>;
+
+    p_pqueue = new pqueue<int>;
+
+    srand(time(NULL));
+
+    while (num_iterations--)
+    {
+        if (rand() % 2)
+        {
+            rand_value = last + (rand() % (RAND_VALUE_MAX + 1));
+
+            printf("enqueue(): %6d: ", rand_value);
+
+            p_rpqueue->enqueue(rand_value);
+
+            p_pqueue->enqueue(rand_value);
+        }
+        else if (p_rpqueue->is_empty() == false)
+        {
+            rand_value = p_rpqueue->dequeue();
+
+            printf("dequeue(): %6d: ", rand_value);
+
+            if (rand_value != p_pqueue->dequeue())
+            {
+                printf("!!! radix heap out of order\n");
+                break;
+            }
+
+            last = rand_value;
+        }
+        else
+        {
+            continue;
+        }
+
+        printf("%d\n", p_rpqueue->size());
+
+        if (p_rpqueue->verify() == false)
+        {
+            printf("!!! radix heap inconsistent\n");
+            break;
+        }
+    }
+
+    delete p_pqueue;
+
+    delete p_rpqueue;
+}
+
+/**
+ * @brief Test binary tree.
+ *
+ * @param[in] num_iterations: Number of iterations.
+ */
+void test_btree(int num_iterations)
+{
+    btree<int> *p_btree;
+    btree<int> *p_btree_other;
+
+    btree<counted> *p_btree_counted;
+
+    llist<int> *p_llist;
+
+    int rand_value, rand_index;
+
+    eytzinger<int> *p_eytzinger;
+
+    int *p_values;
+
+    // batched lookups: -1..RAND_VALUE_MAX + 1 (not a multiple of batch size)
+
+    int keys[RAND_VALUE_MAX + 3];
+
+    btree_node<int> *p_nodes[RAND_VALUE_MAX + 3];
+
+    const int *p_found[RAND_VALUE_MAX + 3];
+
+    std::thread thread;
+
+    int num_errors[2];
+
+    int num_churns = num_iterations; // (random phase counts it down)
+
+    int num_nodes = 0;
+
+    int ii;
+
+    p_btree = new btree<int>;
+
+    p_llist = new llist<int>;
+
+    srand(time(NULL));
+
+    while (num_iterations--)
+    {
+        if (rand() % 2)
+        {
+            rand_value = rand() % (RAND_VALUE_MAX + 1);
+
+            printf("   add(%3d): ", rand_value);
+
+            p_btree->add(rand_value);
+
+            printf("[%2d] ", p_btree->depth(p_btree->p_root));
+
+            if (p_btree->verify(p_btree->p_root, 0) == false)
+            {
+                printf("!!! binary tree inconsistent\n");
+                break;
+            }
+
+            p_llist->add_tail(rand_value);
+
+            num_nodes++;
+
+            print_btree(*(p_btree->p_root));
+        }
+
+        if (num_nodes && (rand() % 2))
+        {
+            llist_node<int> *p_llist_node;
+
+            btree_node<int> *p_btree_node;
+
+            rand_index = rand() % num_nodes;
+
+            p_llist_node = p_llist->p_head;
+
+            while (rand_index--)
+            {
+                p_llist_node = p_llist_node->p_next;
+            }
+
+            printf("  find(%3d): ", p_llist_node->value);
+
+            p_btree_node = p_btree->find(p_btree->p_root,
+                                         p_llist_node->value);
+
+            printf("[%2d] ", p_btree->depth(p_btree_node));
+
+            print_btree(*p_btree_node);
+        }
+
+        if (num_nodes && (rand() % 2))
+        {
+            llist_node<int> *p_llist_node;
+
+            rand_index = rand() % num_nodes;
+
+            p_llist_node = p_llist->p_head;
+
+            while (rand_index--)
+            {
+                p_llist_node = p_llist_node->p_next;
+            }
+
+            printf("remove(%3d): ", p_llist_node->value);
+
+            p_btree->remove(p_llist_node->value);
+
+            printf("[%2d] ", p_btree->depth(p_btree->p_root));
+
+            if (p_btree->verify(p_btree->p_root, 0) == false)
+            {
+                printf("!!! binary tree inconsistent\n");
+                break;
+            }
+
+            p_llist->remove(p_llist_node->value);
+
+            num_nodes--;
+
+            if (num_nodes == 0)
+            {
+                printf("\n");
+            }
+            else
+            {
+                print_btree(*(p_btree->p_root));
+            }
+        }
+    }
+
+    delete p_llist;
+
+    delete p_btree;
+
+    // sorted insertion: degenerate tree (linked list) of maximum depth
+
+    p_btree = new btree<int>;
+
+    for (rand_value = 0; rand_value < RAND_VALUE_MAX * RAND_VALUE_MAX;
+         rand_value++)
+    {
+        p_btree->add(rand_value);
+    }
+
+    printf("sorted add(0..%d): [%2d]\n", rand_value - 1,
+           p_btree->depth(p_btree->p_root));
+
+    if ((p_btree->depth(p_btree->p_root) != rand_value) ||
+        (p_btree->verify(p_btree->p_root, 0) == false) ||
+        (p_btree->find(p_btree->p_root, rand_value - 1) == NULL))
+    {
+        printf("!!! binary tree inconsistent\n");
+    }
+
+    delete p_btree;
+
+    // bulk construction from unsorted values: perfectly balanced
+
+    p_values = new int[RAND_VALUE_MAX * RAND_VALUE_MAX];
+
+    for (ii = 0; ii < RAND_VALUE_MAX * RAND_VALUE_MAX; ii++)
+    {
+        p_values[ii] = rand() % (RAND_VALUE_MAX + 1);
+    }
+
+    p_btree = new btree<int>;
+
+    p_btree->build(p_values, p_values + (RAND_VALUE_MAX * RAND_VALUE_MAX));
+
+    printf(" build(0..%d): [%2d]\n", RAND_VALUE_MAX * RAND_VALUE_MAX - 1,
+           p_btree->depth(p_btree->p_root));
+
+    // 10000 nodes: depth ceil(log2(10001)) = 14
+
+    if ((p_btree->depth(p_btree->p_root) != 14) ||
+        (p_btree->verify(p_btree->p_root, 0) == false))
+    {
+        printf("!!! binary tree inconsistent\n");
+    }
+
+    // rebuilt (non-empty) tree: nodes adjacent, in value order, also while
+    // a tree split from it still holds nodes in it's old slabs
+
+    p_btree_other = p_btree->split(RAND_VALUE_MAX / 2);
+
+    rand_index = p_btree_other->count_range(-1, RAND_VALUE_MAX + 1);
+
+    p_btree->build(p_values, p_values + (RAND_VALUE_MAX * RAND_VALUE_MAX));
+
+    if ((p_btree_other->verify(p_btree_other->p_root, 0) == false) ||
+        (p_btree_other->count_range(-1, RAND_VALUE_MAX + 1) != rand_index))
+    {
+        printf("!!! binary tree split off rebuilt tree inconsistent\n");
+    }
+
+    delete p_btree_other;
+
+    p_btree->build(p_values, p_values + (RAND_VALUE_MAX * RAND_VALUE_MAX));
+
+    p_nodes[0] = p_btree->begin().node();
+
+    for (btree<int>::iterator it = ++p_btree->begin(); it != p_btree->end();
+         ++it)
+    {
+        if (it.node() != p_nodes[0] + 1)
+        {
+            printf("!!! rebuilt binary tree's nodes not contiguous\n");
+            break;
+        }
+
+        p_nodes[0] = it.node();
+    }
+
+    // read-only snapshot & back
+
+    p_eytzinger = p_btree->freeze();
+
+    for (ii = 0; ii < RAND_VALUE_MAX * RAND_VALUE_MAX; ii++)
+    {
+        if ((p_eytzinger->find(p_values[ii]) == NULL) ||
+            (p_eytzinger->lower_bound(p_values[ii] - 1) == NULL) ||
+            (*p_eytzinger->lower_bound(p_values[ii] - 1) > p_values[ii]))
+        {
+            printf("!!! value %d not found in snapshot\n", p_values[ii]);
+            break;
+        }
+    }
+
+    for (ii = 0; ii < RAND_VALUE_MAX + 3; ii++)
+    {
+        keys[ii] = ii - 1;
+    }
+
+    p_btree->find_batch(keys, RAND_VALUE_MAX + 3, p_nodes);
+
+    p_eytzinger->find_batch(keys, RAND_VALUE_MAX + 3, p_found);
+
+    for (ii = 0; ii < RAND_VALUE_MAX + 3; ii++)
+    {
+        if ((p_nodes[ii] != p_btree->find(p_btree->p_root, keys[ii])) ||
+            (p_found[ii] != p_eytzinger->find(keys[ii])))
+        {
+            printf("!!! batched find(%d) incorrect\n", keys[ii]);
+            break;
+        }
+    }
+
+    delete p_btree;
+
+    p_btree = p_eytzinger->thaw();
+
+    printf("freeze/thaw(): [%2d]\n", p_btree->depth(p_btree->p_root));
+
+    if ((p_eytzinger->verify() == false) ||
+        (p_eytzinger->find(RAND_VALUE_MAX + 1) != NULL) ||
+        (p_btree->verify(p_btree->p_root, 0) == false))
+    {
+        printf("!!! snapshot inconsistent\n");
+    }
+
+    delete p_eytzinger;
+
+    // image file: mapped snapshot answers the same queries as tree
+
+    if (p_btree->save("btree.img") == false)
+    {
+        printf("!!! image file not written\n");
+    }
+
+    p_eytzinger = btree<int>::map("btree.img");
+
+    if (p_eytzinger == NULL)
+    {
+        printf("!!! image file not mapped\n");
+    }
+    else
+    {
+        printf("save/map(): %d values\n", p_eytzinger->size());
+
+        for (ii = 0; ii < RAND_VALUE_MAX * RAND_VALUE_MAX; ii++)
+        {
+            if (p_eytzinger->find(p_values[ii]) == NULL)
+            {
+                printf("!!! value %d not found in mapped snapshot\n",
+                       p_values[ii]);
+                break;
+            }
+        }
+
+        for (rand_value = -1; rand_value <= RAND_VALUE_MAX; rand_value++)
+        {
+            if (p_eytzinger->for_each_in_range(rand_value, rand_value + 2,
+                                               [](const int &) {}) !=
+                p_btree->count_range(rand_value, rand_value + 2))
+            {
+                printf("!!! range [%d, %d) incorrect in mapped snapshot\n",
+                       rand_value, rand_value + 2);
+                break;
+            }
+        }
+
+        if ((p_eytzinger->size() != RAND_VALUE_MAX * RAND_VALUE_MAX) ||
+            (p_eytzinger->verify() == false) ||
+            (p_eytzinger->verify_checksum() == false))
+        {
+            printf("!!! mapped snapshot inconsistent\n");
+        }
+
+        delete p_eytzinger;
+    }
+
+    if (btree<long long>::map("btree.img") != NULL)
+    {
+        printf("!!! image file mapped with wrong value type\n");
+    }
+
+    remove("btree.img");
+
+    // range queries vs. linear scan of values, with half the nodes removed
+
+    for (ii = 0; ii < RAND_VALUE_MAX * RAND_VALUE_MAX / 2; ii++)
+    {
+        p_btree->remove(p_values[ii]);
+    }
+
+    for (rand_index = 0; rand_index < RAND_VALUE_MAX; rand_index++)
+    {
+        btree<int>::iterator it;
+
+        int first = rand() % (RAND_VALUE_MAX + 2) - 1;
+        int last  = rand() % (RAND_VALUE_MAX + 2) - 1;
+
+        int count_expected = 0;
+        int count_visited;
+        int value_prev = first;
+
+        for (ii = RAND_VALUE_MAX * RAND_VALUE_MAX / 2;
+             ii < RAND_VALUE_MAX * RAND_VALUE_MAX; ii++)
+        {
+            if ((p_values[ii] >= first) && (p_values[ii] < last))
+            {
+                count_expected++;
+            }
+        }
+
+        count_visited = p_btree->for_each_in_range(first, last,
+            [&value_prev](const int &value)
+            {
+                if (value < value_prev)
+                {
+                    printf("!!! range [%d, %d) out of order\n", value_prev,
+                           value);
+                }
+
+                value_prev = value;
+            });
+
+        it = p_btree->lower_bound(first);
+
+        if ((count_visited != count_expected) ||
+            (p_btree->count_range(first, last) != count_expected) ||
+            ((it != p_btree->end()) && (*it < first)) ||
+            ((first <= last) &&
+             (std::distance(p_btree->lower_bound(first),
+                            p_btree->lower_bound(last)) != count_expected)))
+        {
+            printf("!!! range [%d, %d): %d values, expected %d\n", first,
+                   last, count_visited, count_expected);
+            break;
+        }
+    }
+
+    printf(" range(): %d queries\n", rand_index);
+
+    // order statistics: k-th iterator position vs. select(k) & rank()
+
+    ii = 0;
+
+    for (btree<int>::iterator it = p_btree->begin(); it != p_btree->end();
+         ++it)
+    {
+        if ((p_btree->select(ii) != it) || (p_btree->rank(*it) > ii) ||
+            (p_btree->rank(*it + 1) <= ii))
+        {
+            printf("!!! select(%d)/rank(%d) inconsistent\n", ii, *it);
+            break;
+        }
+
+        ii++;
+    }
+
+    printf("select(%d): %d (p99)\n", ii * 99 / 100,
+           *p_btree->select(ii * 99 / 100));
+
+    if ((ii != RAND_VALUE_MAX * RAND_VALUE_MAX / 2) ||
+        (p_btree->upper_bound(RAND_VALUE_MAX) != p_btree->end()) ||
+        (p_btree->select(ii) != p_btree->end()) ||
+        (p_btree->equal_range(-1).first != p_btree->begin()) ||
+        (p_btree->equal_range(-1).second != p_btree->begin()))
+    {
+        printf("!!! binary tree iteration inconsistent\n");
+    }
+
+    // split at middle value & join back, then join tree from another pool
+
+    p_btree_other = p_btree->split(RAND_VALUE_MAX / 2);
+
+    printf("split(%d): %d + %d values\n", RAND_VALUE_MAX / 2,
+           p_btree->count_range(-1, RAND_VALUE_MAX + 1),
+           p_btree_other->count_range(-1, RAND_VALUE_MAX + 1));
+
+    if ((p_btree->verify(p_btree->p_root, 0) == false) ||
+        (p_btree_other->verify(p_btree_other->p_root, 0) == false) ||
+        (p_btree->count_range(RAND_VALUE_MAX / 2, RAND_VALUE_MAX + 1) != 0) ||
+        (p_btree_other->rank(RAND_VALUE_MAX / 2) != 0) ||
+        (p_btree->count_range(-1, RAND_VALUE_MAX + 1) +
+         p_btree_other->count_range(-1, RAND_VALUE_MAX + 1) !=
+         RAND_VALUE_MAX * RAND_VALUE_MAX / 2))
+    {
+        printf("!!! binary tree split inconsistent\n");
+    }
+
+    p_btree->join(*p_btree_other);
+
+    delete p_btree_other;
+
+    p_btree_other = new btree<int>;
+
+    for (ii = 1; ii <= RAND_VALUE_MAX; ii++)
+    {
+        p_btree_other->add(RAND_VALUE_MAX + ii);
+    }
+
+    p_btree->join(*p_btree_other);
+
+    delete p_btree_other;
+
+    printf("  join(): [%2d]\n", p_btree->depth(p_btree->p_root));
+
+    if ((p_btree->verify(p_btree->p_root, 0) == false) ||
+        (p_btree->count_range(-1, 2 * RAND_VALUE_MAX + 1) !=
+         RAND_VALUE_MAX * RAND_VALUE_MAX / 2 + RAND_VALUE_MAX))
+    {
+        printf("!!! binary tree join inconsistent\n");
+    }
+
+    // trim joined values in one call
+
+    if ((p_btree->erase_range(RAND_VALUE_MAX + 1, 2 * RAND_VALUE_MAX + 1) !=
+         RAND_VALUE_MAX) ||
+        (p_btree->erase_range(0, 0) != 0) ||
+        (p_btree->verify(p_btree->p_root, 0) == false) ||
+        (p_btree->upper_bound(RAND_VALUE_MAX) != p_btree->end()))
+    {
+        printf("!!! binary tree range erase inconsistent\n");
+    }
+
+    // erase middle range of separately built tree
+
+    p_btree_other = new btree<int>;
+
+    p_btree_other->build(p_values,
+                         p_values + (RAND_VALUE_MAX * RAND_VALUE_MAX));
+
+    rand_index = p_btree_other->count_range(RAND_VALUE_MAX / 4,
+                                            RAND_VALUE_MAX * 3 / 4);
+
+    printf("erase_range(%d, %d): %d values\n", RAND_VALUE_MAX / 4,
+           RAND_VALUE_MAX * 3 / 4, rand_index);
+
+    if ((p_btree_other->erase_range(RAND_VALUE_MAX / 4,
+                                    RAND_VALUE_MAX * 3 / 4) != rand_index) ||
+        (p_btree_other->verify(p_btree_other->p_root, 0) == false) ||
+        (p_btree_other->count_range(RAND_VALUE_MAX / 4,
+                                    RAND_VALUE_MAX * 3 / 4) != 0) ||
+        (p_btree_other->count_range(-1, RAND_VALUE_MAX + 1) !=
+         RAND_VALUE_MAX * RAND_VALUE_MAX - rand_index))
+    {
+        printf("!!! binary tree range erase inconsistent\n");
+    }
+
+    delete p_btree_other;
+
+    for (ii = RAND_VALUE_MAX * RAND_VALUE_MAX / 2;
+         ii < RAND_VALUE_MAX * RAND_VALUE_MAX; ii++)
+    {
+        if (p_btree->remove(p_values[ii]) == false)
+        {
+            printf("!!! value %d not removed\n", p_values[ii]);
+            break;
+        }
+    }
+
+    if (p_btree->p_root != NULL)
+    {
+        printf("!!! binary tree not empty\n");
+    }
+
+    delete p_btree;
+
+    delete [] p_values;
+
+    // split-off tree churned (& deleted) by another thread at the same time
+
+    p_btree = new btree<int>;
+
+    for (ii = 0; ii < 2 * RAND_VALUE_MAX; ii++)
+    {
+        p_btree->add(ii);
+    }
+
+    p_btree_other = p_btree->split(RAND_VALUE_MAX);
+
+    thread = std::thread(test_btree_thread, p_btree_other, num_churns,
+                         RAND_VALUE_MAX, &num_errors[1]);
+
+    test_btree_thread(p_btree, num_churns, 0, &num_errors[0]);
+
+    thread.join();
+
+    printf("split() trees in 2 threads, %d churns each: %d + %d errors\n",
+           num_churns, num_errors[0], num_errors[1]);
+
+    if ((num_errors[0] != 0) || (num_errors[1] != 0))
+    {
+        printf("!!! binary tree split off in other thread inconsistent\n");
+    }
+
+    // values are constructed in place & moved, never copied
+
+    p_btree_counted = new btree<counted>;
+
+    counted::reset();
+
+    p_btree_counted->emplace(2);
+    p_btree_counted->emplace(1);
+    p_btree_counted->emplace(1, 2);
+
+    if (counted::num_moves != 0)
+    {
+        printf("!!! binary tree emplace moved values\n");
+    }
+
+    p_btree_counted->add(counted(4));
+
+    if ((p_btree_counted->find(p_btree_counted->p_root, counted(3)) == NULL) ||
+        (p_btree_counted->remove(counted(2)) == false) ||
+        (p_btree_counted->rank(counted(4)) != 2))
+    {
+        printf("!!! binary tree with moved values inconsistent\n");
+    }
+
+    if (counted::num_copies != 0)
+    {
+        printf("!!! binary tree copied values\n");
+    }
+
+    delete p_btree_counted;
+}
+
+/**
+ * @brief Binary tree test thread: remove & re-add values of tree (split from
+ *        one used by another thread at the same time), then delete tree.
+ *
+ * @param[in,out] p_btree:        Pointer to binary tree (deleted).
+ * @param[in]     num_iterations: Number of iterations.
+ * @param[in]     value_min:      Smallest value (tree holds RAND_VALUE_MAX
+ *                                consecutive values).
+ * @param[out]    p_num_errors:   Pointer to number of errors.
+ */
+void test_btree_thread(btree<int> *p_btree, int num_iterations, int value_min,
+                       int *p_num_errors)
+{
+    int value;
+
+    int ii;
+
+    *p_num_errors = 0;
+
+    for (ii = 0; ii < num_iterations; ii++)
+    {
+        value = value_min + ((ii * 7) % RAND_VALUE_MAX);
+
+        if (p_btree->remove(value) == false)
+        {
+            (*p_num_errors)++;
+        }
+
+        p_btree->add(value);
+
+        // odd iterations: value twice for a moment (one more node needed)
+
+        if (ii % 2)
+        {
+            p_btree->add(value);
+
+            if (p_btree->remove(value) == false)
+            {
+                (*p_num_errors)++;
+            }
+        }
+    }
+
+    if ((p_btree->verify(p_btree->p_root, value_min - 1) == false) ||
+        (p_btree->count_range(value_min, value_min + RAND_VALUE_MAX) !=
+         RAND_VALUE_MAX))
+    {
+        (*p_num_errors)++;
+    }
+
+    delete p_btree;
+}
+
+/**
+ * @brief Test AVL tree.
+ *
+ * @param[in] num_iterations: Number of iterations.
+ */
+void test_avltree(int num_iterations)
+{
+    avltree<int> *p_avltree;
+
+    llist<int> *p_llist;
+
+    int rand_value, rand_index;
+
+    int num_nodes = 0;
+
+    p_avltree = new avltree<int>;
+
+    p_llist = new llist<int>;
+
+    srand(time(NULL));
+
+    while (num_iterations--)
+    {
+        if (rand() % 2)
+        {
+            rand_value = rand() % (RAND_VALUE_MAX + 1);
+
+            printf("   add(%3d): ", rand_value);
+
+            p_avltree->add(rand_value);
+
+            printf("[%2d] ", p_avltree->depth(p_avltree->p_root));
+
+            if (p_avltree->verify(p_avltree->p_root, 0) == false)
+            {
+                printf("!!! AVL tree inconsistent\n");
+                break;
+            }
+
+            p_llist->add_tail(rand_value);
+
+            num_nodes++;
+
+            print_avltree(*(p_avltree->p_root));
+        }
+
+        if (num_nodes && (rand() % 2))
+        {
+            llist_node<int> *p_llist_node;
+
+            avltree_node<int> *p_avltree_node;
+
+            rand_index = rand() % num_nodes;
+
+            p_llist_node = p_llist->p_head;
+
+            while (rand_index--)
+            {
+                p_llist_node = p_llist_node->p_next;
+            }
+
+            printf("  find(%3d): ", p_llist_node->value);
+
+            p_avltree_node = p_avltree->find(p_avltree->p_root,
+                                         p_llist_node->value);
+
+            printf("[%2d] ", p_avltree->depth(p_avltree_node));
+
+            print_avltree(*p_avltree_node);
+        }
+
+        if (num_nodes && (rand() % 2))
+        {
+            llist_node<int> *p_llist_node;
+
+            rand_index = rand() % num_nodes;
+
+            p_llist_node = p_llist->p_head;
+
+            while (rand_index--)
+            {
+                p_llist_node = p_llist_node->p_next;
+            }
+
+            printf("remove(%3d): ", p_llist_node->value);
+
+            p_avltree->remove(p_llist_node->value);
+
+            printf("[%2d] ", p_avltree->depth(p_avltree->p_root));
+
+            if (p_avltree->verify(p_avltree->p_root, 0) == false)
+            {
+                printf("!!! AVL tree inconsistent\n");
+                break;
+            }
+
+            p_llist->remove(p_llist_node->value);
+
+            num_nodes--;
+
+            if (num_nodes == 0)
+            {
+                printf("\n");
+            }
+            else
+            {
+                print_avltree(*(p_avltree->p_root));
+            }
+        }
+    }
+
+    delete p_llist;
+
+    delete p_avltree;
+
+    // sorted insertion: depth must stay below 1.45 * log2(n + 2) (19.3)
+
+    p_avltree = new avltree<int>;
+
+    for (rand_value = 0; rand_value < RAND_VALUE_MAX * RAND_VALUE_MAX;
+         rand_value++)
+    {
+        p_avltree->add(rand_value);
+    }
+
+    printf("sorted add(0..%d): [%2d]\n", rand_value - 1,
+           p_avltree->depth(p_avltree->p_root));
+
+    if ((p_avltree->depth(p_avltree->p_root) > 19) ||
+        (p_avltree->verify(p_avltree->p_root, 0) == false))
+    {
+        printf("!!! AVL tree unbalanced\n");
+    }
+
+    delete p_avltree;
+}
+
+/**
+ * @brief Test B+tree.
+ *
+ * @param[in] num_iterations: Number of iterations.
+ */
+void test_bptree(int num_iterations)
+{
+    bptree<int> *p_bptree;
+
+    llist<int> *p_llist;
+
+    llist_node<int> *p_llist_node;
+
+    int rand_value, rand_index;
+
+    int *p_keys;
+
+    const int **pp_found;
+
+    int num_nodes = 0;
+
+    int ii;
+
+    p_bptree = new bptree<int>;
+
+    p_llist = new llist<int>;
+
+    srand(time(NULL));
+
+    while (num_iterations--)
+    {
+        if (rand() % 2)
+        {
+            rand_value = rand() % (RAND_VALUE_MAX + 1);
+
+            printf("   add(%3d): ", rand_value);
+
+            p_bptree->add(rand_value);
+
+            p_llist->add_tail(rand_value);
+
+            num_nodes++;
+        }
+        else if (num_nodes && (rand() % 2))
+        {
+            rand_index = rand() % num_nodes;
+
+            p_llist_node = p_llist->p_head;
+
+            while (rand_index--)
+            {
+                p_llist_node = p_llist_node->p_next;
+            }
+
+            printf("remove(%3d): ", p_llist_node->value);
+
+            if (p_bptree->remove(p_llist_node->value) == false)
+            {
+                printf("!!! key not removed\n");
+                break;
+            }
+
+            p_llist->remove(p_llist_node->value);
+
+            num_nodes--;
+        }
+        else
+        {
+            rand_value = rand() % (RAND_VALUE_MAX + 1);
+
+            printf("  find(%3d): ", rand_value);
+
+            if ((p_bptree->find(rand_value) != NULL) !=
+                (p_llist->find_with_prev(rand_value, &p_llist_node) != NULL))
+            {
+                printf("!!! key lookup incorrect\n");
+                break;
+            }
+        }
+
+        printf("[%2d] ", p_bptree->depth());
+
+        print_bptree(p_bptree->p_first);
+
+        if (p_bptree->verify() == false)
+        {
+            printf("!!! B+tree inconsistent\n");
+            break;
+        }
+    }
+
+    delete p_llist;
+
+    delete p_bptree;
+
+    // batched lookups: every key twice (equal keys spanning leaves), looked
+    // up from -1 to past largest key (not a multiple of batch size)
+
+    p_bptree = new bptree<int>;
+
+    for (ii = 0; ii < 2 * RAND_VALUE_MAX * RAND_VALUE_MAX; ii++)
+    {
+        p_bptree->add(ii / 2);
+    }
+
+    p_keys = new int[RAND_VALUE_MAX * RAND_VALUE_MAX + 3];
+
+    pp_found = new const int *[RAND_VALUE_MAX * RAND_VALUE_MAX + 3];
+
+    for (ii = 0; ii < RAND_VALUE_MAX * RAND_VALUE_MAX + 3; ii++)
+    {
+        p_keys[ii] = ii - 1;
+    }
+
+    p_bptree->find_batch(p_keys, RAND_VALUE_MAX * RAND_VALUE_MAX + 3,
+                         pp_found);
+
+    printf("find_batch(): [%2d] %d keys\n", p_bptree->depth(),
+           RAND_VALUE_MAX * RAND_VALUE_MAX + 3);
+
+    for (ii = 0; ii < RAND_VALUE_MAX * RAND_VALUE_MAX + 3; ii++)
+    {
+        if ((pp_found[ii] != p_bptree->find(p_keys[ii])) ||
+            ((pp_found[ii] != NULL) !=
+             ((p_keys[ii] >= 0) &&
+              (p_keys[ii] < RAND_VALUE_MAX * RAND_VALUE_MAX))))
+        {
+            printf("!!! batched find(%d) incorrect\n", p_keys[ii]);
+            break;
+        }
+    }
+
+    delete [] pp_found;
+
+    delete [] p_keys;
+
+    delete p_bptree;
+}
+
+/**
+ * @brief Concurrent B+tree test thread: add, remove & look up random keys
+ *        owned by this thread (key % NUM_THREADS == thread index), checking
+ *        every result against a private record of owned keys, while looking
+ *        up other threads' keys too.
+ *
+ * @param[in,out] p_cbtree:       Pointer to concurrent B+tree.
+ * @param[in]     num_iterations: Number of iterations.
+ * @param[in]     thread_index:   Thread index.
+ * @param[out]    p_num_keys:     Pointer to number of keys left in tree.
+ * @param[out]    p_num_errors:   Pointer to number of incorrect results.
+ */
+void test_cbtree_thread(cbtree<int> *p_cbtree, int num_iterations,
+                        int thread_index, int *p_num_keys, int *p_num_errors)
+{
+    unsigned int seed = (unsigned int)(uintptr_t)p_num_keys;
+
+    bool *p_owned = new bool[RAND_VALUE_MAX * RAND_VALUE_MAX]();
+
+    int index;
+    int key;
 
     while (num_iterations--)
     {
-        if (rand() % 2)
+        index = rand_r(&seed) % (RAND_VALUE_MAX * RAND_VALUE_MAX);
+
+        key = index * NUM_THREADS + thread_index;
+
+        if (rand_r(&seed) % 3)
         {
-            rand_value = rand() % (RAND_VALUE_MAX + 1);
+            if (p_cbtree->add(key) == p_owned[index])
+            {
+                (*p_num_errors)++;
+            }
 
-            printf("enqueue(): %3d: ", rand_value);
+            if (p_owned[index] == false)
+            {
+                p_owned[index] = true;
 
-            p_pqueue->enqueue(rand_value);
+                (*p_num_keys)++;
+            }
+        }
+        else
+        {
+            if (p_cbtree->remove(key) != p_owned[index])
+            {
+                (*p_num_errors)++;
+            }
 
-            print_llist(p_pqueue->p_llist->p_head);
+            if (p_owned[index])
+            {
+                p_owned[index] = false;
+
+                (*p_num_keys)--;
+            }
         }
 
-        if ((p_pqueue->is_empty() == false) && (rand() % 2))
+        if (p_cbtree->contains(key) != p_owned[index])
         {
-            printf("dequeue(): %3d: ", p_pqueue->dequeue());
-
-            print_llist(p_pqueue->p_llist->p_head);
+            (*p_num_errors)++;
         }
+
+        p_cbtree->contains(rand_r(&seed) % (RAND_VALUE_MAX * RAND_VALUE_MAX *
+                                            NUM_THREADS));
     }
 
-    delete p_pqueue;
+    delete [] p_owned;
 }
 
 /**
- * @brief Test binary tree.
+ * @brief Test concurrent B+tree.
  *
- * @param[in] num_iterations: Number of iterations.
+ * @param[in] num_iterations: Number of iterations (per thread).
  */
-void test_btree(int num_iterations)
+void test_cbtree(int num_iterations)
 {
-    btree<int> *p_btree;
+    cbtree<int> *p_cbtree;
 
-    llist<int> *p_llist;
+    std::thread threads[NUM_THREADS];
 
-    int rand_value, rand_index;
+    bool present[RAND_VALUE_MAX + 1] = { false };
 
-    int num_nodes = 0;
+    int num_keys[NUM_THREADS]   = { 0 };
+    int num_errors[NUM_THREADS] = { 0 };
 
-    p_btree = new btree<int>;
+    int num_keys_total = 0;
 
-    p_llist = new llist<int>;
+    int rand_value;
+
+    int ii;
+
+    // single thread: set semantics
+
+    p_cbtree = new cbtree<int>;
 
     srand(time(NULL));
 
-    while (num_iterations--)
+    for (ii = 0; ii < num_iterations; ii++)
     {
+        rand_value = rand() % (RAND_VALUE_MAX + 1);
+
         if (rand() % 2)
         {
-            rand_value = rand() % (RAND_VALUE_MAX + 1);
+            printf("     add(%3d): ", rand_value);
 
-            printf("   add(%3d): ", rand_value);
-
-            p_btree->add(rand_value);
+            if (p_cbtree->add(rand_value) == present[rand_value])
+            {
+                printf("!!! key added twice or not added\n");
+                break;
+            }
 
-            printf("[%2d] ", p_btree->depth(p_btree->p_root));
+            present[rand_value] = true;
+        }
+        else if (rand() % 2)
+        {
+            printf("  remove(%3d): ", rand_value);
 
-            if (p_btree->verify(p_btree->p_root, 0) == false)
+            if (p_cbtree->remove(rand_value) != present[rand_value])
             {
-                printf("!!! binary tree inconsistent\n");
+                printf("!!! key removed but absent or not removed\n");
                 break;
             }
 
-            p_llist->add_tail(rand_value);
-
-            num_nodes++;
+            present[rand_value] = false;
+        }
+        else
+        {
+            printf("contains(%3d): ", rand_value);
 
-            print_btree(*(p_btree->p_root));
+            if (p_cbtree->contains(rand_value) != present[rand_value])
+            {
+                printf("!!! key lookup incorrect\n");
+                break;
+            }
         }
 
-        if (num_nodes && (rand() % 2))
+        printf("%d keys\n", p_cbtree->size());
+
+        if (p_cbtree->verify() == false)
         {
-            llist_node<int> *p_llist_node;
+            printf("!!! concurrent B+tree inconsistent\n");
+            break;
+        }
+    }
 
-            btree_node<int> *p_btree_node;
+    delete p_cbtree;
 
-            rand_index = rand() % num_nodes;
+    // threads: disjoint keys, shared nodes (splits under concurrent access)
 
-            p_llist_node = p_llist->p_head;
+    p_cbtree = new cbtree<int>;
 
-            while (rand_index--)
-            {
-                p_llist_node = p_llist_node->p_next;
-            }
+    for (ii = 0; ii < NUM_THREADS; ii++)
+    {
+        threads[ii] = std::thread(test_cbtree_thread, p_cbtree, num_iterations,
+                                  ii, &num_keys[ii], &num_errors[ii]);
+    }
 
-            printf("  find(%3d): ", p_llist_node->value);
+    for (ii = 0; ii < NUM_THREADS; ii++)
+    {
+        threads[ii].join();
 
-            p_btree_node = p_btree->find(p_btree->p_root,
-                                         p_llist_node->value);
+        printf("thread %d: %d keys, %d errors\n", ii, num_keys[ii],
+               num_errors[ii]);
 
-            printf("[%2d] ", p_btree->depth(p_btree_node));
+        num_keys_total += num_keys[ii];
 
-            print_btree(*p_btree_node);
+        if (num_errors[ii] > 0)
+        {
+            printf("!!! concurrent B+tree lookup incorrect\n");
         }
+    }
 
-        if (num_nodes && (rand() % 2))
+    printf("total:    %d keys\n", p_cbtree->size());
+
+    if ((p_cbtree->size() != num_keys_total) || (p_cbtree->verify() == false))
+    {
+        printf("!!! concurrent B+tree inconsistent\n");
+    }
+
+    delete p_cbtree;
+}
+
+/**
+ * @brief Persistent binary tree test thread: add up snapshot's values, then
+ *        delete snapshot (while main thread keeps changing tree).
+ *
+ * @param[in,out] p_snapshot: Pointer to snapshot.
+ * @param[out]    p_sum:      Pointer to sum of values.
+ */
+void test_pbtree_thread(const pbtree<int> *p_snapshot, long long *p_sum)
+{
+    p_snapshot->for_each([p_sum](const int &value) { *p_sum += value; });
+
+    delete p_snapshot;
+}
+
+/**
+ * @brief Test persistent binary tree.
+ *
+ * @param[in] num_iterations: Number of iterations.
+ */
+void test_pbtree(int num_iterations)
+{
+    pbtree<int> *p_pbtree;
+
+    const pbtree<int> *p_snapshot = NULL;
+
+    llist<int> *p_llist;
+
+    llist_node<int> *p_llist_node;
+
+    std::thread thread;
+
+    int counts[RAND_VALUE_MAX + 1] = { 0 };
+    int counts_snapshot[RAND_VALUE_MAX + 1];
+
+    long long sum_expected;
+    long long sum = 0;
+
+    int rand_value, rand_index;
+
+    int num_nodes = 0;
+
+    int ii;
+
+    p_pbtree = new pbtree<int>;
+
+    p_llist = new llist<int>;
+
+    srand(time(NULL));
+
+    for (ii = 0; ii < num_iterations; ii++)
+    {
+        if (rand() % 2)
         {
-            llist_node<int> *p_llist_node;
+            rand_value = rand() % (RAND_VALUE_MAX + 1);
 
+            printf("     add(%3d): ", rand_value);
+
+            p_pbtree->add(rand_value);
+
+            p_llist->add_tail(rand_value);
+
+            counts[rand_value]++;
+
+            num_nodes++;
+        }
+        else if (num_nodes && (rand() % 2))
+        {
             rand_index = rand() % num_nodes;
 
             p_llist_node = p_llist->p_head;
@@ -528,36 +3430,95 @@ void test_btree(int num_iterations)
                 p_llist_node = p_llist_node->p_next;
             }
 
-            printf("remove(%3d): ", p_llist_node->value);
-
-            p_btree->remove(p_llist_node->value);
+            rand_value = p_llist_node->value;
 
-            printf("[%2d] ", p_btree->depth(p_btree->p_root));
+            printf("  remove(%3d): ", rand_value);
 
-            if (p_btree->verify(p_btree->p_root, 0) == false)
+            if (p_pbtree->remove(rand_value) == false)
             {
-                printf("!!! binary tree inconsistent\n");
+                printf("!!! node not removed\n");
                 break;
             }
 
-            p_llist->remove(p_llist_node->value);
+            p_llist->remove(rand_value);
+
+            counts[rand_value]--;
 
             num_nodes--;
+        }
+        else
+        {
+            // check last snapshot against value counts at the time, replace it
 
-            if (num_nodes == 0)
-            {
-                printf("\n");
-            }
-            else
+            printf("snapshot(%3d): ", num_nodes);
+
+            if (p_snapshot != NULL)
             {
-                print_btree(*(p_btree->p_root));
+                p_snapshot->for_each([&counts_snapshot](const int &value)
+                                     {
+                                         counts_snapshot[value]--;
+                                     });
+
+                for (rand_value = 0; rand_value <= RAND_VALUE_MAX;
+                     rand_value++)
+                {
+                    if (counts_snapshot[rand_value] != 0)
+                    {
+                        printf("!!! snapshot changed\n");
+                        break;
+                    }
+                }
+
+                delete p_snapshot;
             }
+
+            p_snapshot = p_pbtree->snapshot();
+
+            memcpy(counts_snapshot, counts, sizeof(counts));
+        }
+
+        printf("[%2d] %d nodes\n", p_pbtree->depth(), p_pbtree->size());
+
+        if ((p_pbtree->verify() == false) ||
+            (p_pbtree->size() != num_nodes))
+        {
+            printf("!!! persistent binary tree inconsistent\n");
+            break;
         }
     }
 
+    delete p_snapshot;
+
+    // snapshot read (& deleted) by another thread while tree changes
+
+    sum_expected = 0;
+
+    p_pbtree->for_each([&sum_expected](const int &value)
+                       {
+                           sum_expected += value;
+                       });
+
+    thread = std::thread(test_pbtree_thread, p_pbtree->snapshot(), &sum);
+
+    for (ii = 0; ii < num_iterations; ii++)
+    {
+        p_pbtree->add(rand() % (RAND_VALUE_MAX + 1));
+
+        p_pbtree->remove(rand() % (RAND_VALUE_MAX + 1));
+    }
+
+    thread.join();
+
+    printf("snapshot sum: %lld (expected %lld)\n", sum, sum_expected);
+
+    if ((sum != sum_expected) || (p_pbtree->verify() == false))
+    {
+        printf("!!! persistent binary tree snapshot inconsistent\n");
+    }
+
     delete p_llist;
 
-    delete p_btree;
+    delete p_pbtree;
 }
 
 /**
@@ -603,6 +3564,32 @@ void print_dllist(dllist_node<int> *p_node)
     }
 }
 
+/**
+ * @brief Print unrolled linked list.
+ *
+ * @param[in] p_node: Pointer to node structure.
+ */
+void print_ullist(ullist_node<int> *p_node)
+{
+    int ii;
+
+    while (p_node != NULL)
+    {
+        printf("[");
+
+        for (ii = 0; ii < p_node->num_values; ii++)
+        {
+            printf("%4d", p_node->values[ii]);
+        }
+
+        printf(" ] -> ");
+
+        p_node = p_node->p_next;
+    }
+
+    printf("NULL\n");
+}
+
 /**
  * @brief Print binary tree in breadth-first order.
  *
@@ -634,6 +3621,63 @@ void print_btree(btree_node<int> node)
     printf("\n");
 }
 
+/**
+ * @brief Print AVL tree in breadth-first order.
+ *
+ * @param[in] node: AVL tree's root node.
+ */
+void print_avltree(avltree_node<int> node)
+{
+    queue < avltree_node <int> > avltree_queue;
+
+    avltree_queue.enqueue(node);
+
+    while (avltree_queue.is_empty() == false)
+    {
+        node = avltree_queue.dequeue();
+
+        printf("%3d ", node.value);
+
+        if (node.p_left != NULL)
+        {
+            avltree_queue.enqueue(*(node.p_left));
+        }
+
+        if (node.p_right != NULL)
+        {
+            avltree_queue.enqueue(*(node.p_right));
+        }
+    }
+
+    printf("\n");
+}
+
+/**
+ * @brief Print B+tree's leaves in key order.
+ *
+ * @param[in] p_leaf: Pointer to first leaf.
+ */
+void print_bptree(bptree_leaf<int> *p_leaf)
+{
+    int ii;
+
+    while (p_leaf != NULL)
+    {
+        printf("[");
+
+        for (ii = 0; ii < p_leaf->num_keys; ii++)
+        {
+            printf("%4d", p_leaf->keys[ii]);
+        }
+
+        printf(" ] -> ");
+
+        p_leaf = p_leaf->p_next;
+    }
+
+    printf("NULL\n");
+}
+
 /**
  * @brief Get basename from string containing file + full path.
  *
@@ -0,0 +1,655 @@
+/**
+ * @file  ullist.h
+ *
+ * @brief Unrolled linked list class.
+ */
+
+#ifndef _ULLIST_H_
+
+#define _ULLIST_H_
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <new>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#define ULLIST_CACHE_LINE_SIZE 64 ///< cache line size in bytes
+
+#ifndef ULLIST_NODE_SIZE
+#define ULLIST_NODE_SIZE 256 ///< node size in bytes (multiple of cache line)
+#endif
+
+/// unrolled linked list node structure
+template <typename T>
+struct ullist_node {
+    /// number of values per node
+    static const int capacity =
+        ((ULLIST_NODE_SIZE - 16) / (int)sizeof(T) > 0) ?
+        ((ULLIST_NODE_SIZE - 16) / (int)sizeof(T)) : 1;
+
+    T               values[capacity]; ///< node values
+    int             num_values;       ///< number of values in node
+    ullist_node<T> *p_next;           ///< pointer to next node
+};
+
+/**
+ * @brief SIMD traits: how to broadcast & compare a vector's worth of values
+ *        of type T (only defined for arithmetic types).
+ */
+template <typename T,
+          bool   is_integral = std::is_integral<T>::value,
+          size_t size        = sizeof(T)>
+struct ullist_simd {
+    static const bool supported = false; ///< no vector search for T
+};
+
+#if defined(__SSE2__)
+
+/// SIMD traits: 8-bit integers
+template <typename T>
+struct ullist_simd<T, true, 1> {
+    static const bool supported = true;
+
+    static __m128i set1(T value) { return _mm_set1_epi8((char)value); }
+
+    static __m128i cmpeq(__m128i a, __m128i b) { return _mm_cmpeq_epi8(a, b); }
+
+#if defined(__AVX2__)
+    static __m256i set1_256(T value) { return _mm256_set1_epi8((char)value); }
+
+    static __m256i cmpeq_256(__m256i a, __m256i b)
+    {
+        return _mm256_cmpeq_epi8(a, b);
+    }
+#endif
+};
+
+/// SIMD traits: 16-bit integers
+template <typename T>
+struct ullist_simd<T, true, 2> {
+    static const bool supported = true;
+
+    static __m128i set1(T value) { return _mm_set1_epi16((short)value); }
+
+    static __m128i cmpeq(__m128i a, __m128i b) { return _mm_cmpeq_epi16(a, b); }
+
+#if defined(__AVX2__)
+    static __m256i set1_256(T value) { return _mm256_set1_epi16((short)value); }
+
+    static __m256i cmpeq_256(__m256i a, __m256i b)
+    {
+        return _mm256_cmpeq_epi16(a, b);
+    }
+#endif
+};
+
+/// SIMD traits: 32-bit integers
+template <typename T>
+struct ullist_simd<T, true, 4> {
+    static const bool supported = true;
+
+    static __m128i set1(T value) { return _mm_set1_epi32((int)value); }
+
+    static __m128i cmpeq(__m128i a, __m128i b) { return _mm_cmpeq_epi32(a, b); }
+
+#if defined(__AVX2__)
+    static __m256i set1_256(T value) { return _mm256_set1_epi32((int)value); }
+
+    static __m256i cmpeq_256(__m256i a, __m256i b)
+    {
+        return _mm256_cmpeq_epi32(a, b);
+    }
+#endif
+};
+
+/// SIMD traits: 64-bit integers
+template <typename T>
+struct ullist_simd<T, true, 8> {
+    static const bool supported = true;
+
+    static __m128i set1(T value) { return _mm_set1_epi64x((long long)value); }
+
+    static __m128i cmpeq(__m128i a, __m128i b)
+    {
+        // SSE2 has no 64-bit compare: both 32-bit halves must match
+
+        __m128i eq = _mm_cmpeq_epi32(a, b);
+
+        return _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+    }
+
+#if defined(__AVX2__)
+    static __m256i set1_256(T value)
+    {
+        return _mm256_set1_epi64x((long long)value);
+    }
+
+    static __m256i cmpeq_256(__m256i a, __m256i b)
+    {
+        return _mm256_cmpeq_epi64(a, b);
+    }
+#endif
+};
+
+/// SIMD traits: single-precision floating point
+template <>
+struct ullist_simd<float, false, 4> {
+    static const bool supported = true;
+
+    static __m128i set1(float value)
+    {
+        return _mm_castps_si128(_mm_set1_ps(value));
+    }
+
+    static __m128i cmpeq(__m128i a, __m128i b)
+    {
+        return _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(a),
+                                             _mm_castsi128_ps(b)));
+    }
+
+#if defined(__AVX2__)
+    static __m256i set1_256(float value)
+    {
+        return _mm256_castps_si256(_mm256_set1_ps(value));
+    }
+
+    static __m256i cmpeq_256(__m256i a, __m256i b)
+    {
+        return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a),
+                                                 _mm256_castsi256_ps(b),
+                                                 _CMP_EQ_OQ));
+    }
+#endif
+};
+
+/// SIMD traits: double-precision floating point
+template <>
+struct ullist_simd<double, false, 8> {
+    static const bool supported = true;
+
+    static __m128i set1(double value)
+    {
+        return _mm_castpd_si128(_mm_set1_pd(value));
+    }
+
+    static __m128i cmpeq(__m128i a, __m128i b)
+    {
+        return _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(a),
+                                             _mm_castsi128_pd(b)));
+    }
+
+#if defined(__AVX2__)
+    static __m256i set1_256(double value)
+    {
+        return _mm256_castpd_si256(_mm256_set1_pd(value));
+    }
+
+    static __m256i cmpeq_256(__m256i a, __m256i b)
+    {
+        return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(a),
+                                                 _mm256_castsi256_pd(b),
+                                                 _CMP_EQ_OQ));
+    }
+#endif
+};
+
+#endif // #if defined(__SSE2__)
+
+/// value search within a node (scalar version)
+template <typename T, bool simd = ullist_simd<T>::supported>
+struct ullist_search {
+    /**
+     * @brief Find index of first value equal to specific value.
+     *
+     * @param[in] p_values:   Pointer to values.
+     * @param[in] num_values: Number of values.
+     * @param[in] value:      Value.
+     *
+     * @retval -1 if value not found.
+     * @retval Index of value.
+     */
+    static int find(const T *p_values, int num_values, const T &value)
+    {
+        int ii;
+
+        for (ii = 0; ii < num_values; ii++)
+        {
+            if (p_values[ii] == value)
+            {
+                return ii;
+            }
+        }
+
+        return -1;
+    }
+};
+
+#if defined(__SSE2__)
+
+/// value search within a node (vector version)
+template <typename T>
+struct ullist_search<T, true> {
+    /**
+     * @brief Find index of first value equal to specific value.
+     *
+     * Compares a whole vector of values at a time; the compare mask is
+     * reduced with a byte-wise movemask, so each matching value sets
+     * sizeof(T) consecutive mask bits.
+     *
+     * @param[in] p_values:   Pointer to values.
+     * @param[in] num_values: Number of values.
+     * @param[in] value:      Value.
+     *
+     * @retval -1 if value not found.
+     * @retval Index of value.
+     */
+    static int find(const T *p_values, int num_values, const T &value)
+    {
+        int ii = 0;
+
+        unsigned int mask;
+
+#if defined(__AVX2__)
+        const int per_vector_256 = 32 / (int)sizeof(T);
+
+        __m256i key_256 = ullist_simd<T>::set1_256(value);
+
+        for (; ii + per_vector_256 <= num_values; ii += per_vector_256)
+        {
+            __m256i data = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i *>(p_values + ii));
+
+            mask = (unsigned int)_mm256_movemask_epi8(
+                ullist_simd<T>::cmpeq_256(data, key_256));
+
+            if (mask != 0)
+            {
+                return ii + (__builtin_ctz(mask) / (int)sizeof(T));
+            }
+        }
+#endif
+
+        const int per_vector = 16 / (int)sizeof(T);
+
+        __m128i key = ullist_simd<T>::set1(value);
+
+        for (; ii + per_vector <= num_values; ii += per_vector)
+        {
+            __m128i data = _mm_loadu_si128(
+                reinterpret_cast<const __m128i *>(p_values + ii));
+
+            mask = (unsigned int)_mm_movemask_epi8(
+                ullist_simd<T>::cmpeq(data, key));
+
+            if (mask != 0)
+            {
+                return ii + (__builtin_ctz(mask) / (int)sizeof(T));
+            }
+        }
+
+        for (; ii < num_values; ii++)
+        {
+            if (p_values[ii] == value)
+            {
+                return ii;
+            }
+        }
+
+        return -1;
+    }
+};
+
+#endif // #if defined(__SSE2__)
+
+/**
+ * @brief Unrolled linked list class.
+ *
+ * Same interface as llist, but each node holds a cache-line-aligned block of
+ * values, so scans chase one pointer per block instead of one per value. For
+ * arithmetic types the scan within a block is vectorised (SSE2/AVX2).
+ */
+template <typename T>
+class ullist
+{
+public:
+
+    /**
+     * @brief Constructor.
+     */
+    ullist()
+    {
+        p_head = NULL;
+        p_tail = NULL;
+
+        num_values = 0;
+    }
+
+    /**
+     * @brief Destructor.
+     */
+    ~ullist()
+    {
+        ullist_node<T> *p_prev;
+        ullist_node<T> *p_next;
+
+        p_next = p_head;
+
+        while (p_next != NULL)
+        {
+            p_prev = p_next;
+
+            p_next = p_next->p_next;
+
+            num_values -= p_prev->num_values;
+
+            node_delete(p_prev);
+        }
+
+        p_head = NULL;
+        p_tail = NULL;
+    }
+
+    /**
+     * @brief Add value to head of list.
+     *
+     * @param[in] value: Value.
+     */
+    void add_head(T value)
+    {
+        int ii;
+
+        if ((p_head == NULL) ||
+            (p_head->num_values == ullist_node<T>::capacity))
+        {
+            ullist_node<T> *p_node;
+
+            p_node = node_create();
+
+            p_node->p_next = p_head;
+
+            p_head = p_node;
+
+            if (p_tail == NULL)
+            {
+                p_tail = p_node;
+            }
+        }
+
+        for (ii = p_head->num_values; ii > 0; ii--)
+        {
+            p_head->values[ii] = p_head->values[ii - 1];
+        }
+
+        p_head->values[0] = value;
+
+        p_head->num_values++;
+
+        num_values++;
+    }
+
+    /**
+     * @brief Add value to tail of list.
+     *
+     * @param[in] value: Value.
+     */
+    void add_tail(T value)
+    {
+        if ((p_tail == NULL) ||
+            (p_tail->num_values == ullist_node<T>::capacity))
+        {
+            ullist_node<T> *p_node;
+
+            p_node = node_create();
+
+            if (p_tail == NULL)
+            {
+                p_head = p_node;
+            }
+            else
+            {
+                p_tail->p_next = p_node;
+            }
+
+            p_tail = p_node;
+        }
+
+        p_tail->values[p_tail->num_values] = value;
+
+        p_tail->num_values++;
+
+        num_values++;
+    }
+
+    /**
+     * @brief Delete value at head of list.
+     */
+    void delete_head()
+    {
+        if (num_values)
+        {
+            value_delete(NULL, p_head, 0);
+        }
+    }
+
+    /**
+     * @brief Delete value at tail of list.
+     */
+    void delete_tail()
+    {
+        if (num_values)
+        {
+            ullist_node<T> *p_prev = NULL;
+            ullist_node<T> *p_next;
+
+            p_next = p_head;
+
+            if (p_tail->num_values == 1)
+            {
+                // tail node is about to be freed: find it's predecessor
+
+                while (p_next != p_tail)
+                {
+                    p_prev = p_next;
+                    p_next = p_next->p_next;
+                }
+            }
+
+            value_delete(p_prev, p_tail, p_tail->num_values - 1);
+        }
+    }
+
+    /**
+     * @brief Remove first occurrence of value from list.
+     *
+     * @param[in] value: Value.
+     */
+    void remove(T value)
+    {
+        ullist_node<T> *p_prev = NULL;
+        ullist_node<T> *p_node;
+
+        int index = -1;
+
+        p_node = p_head;
+
+        while (p_node != NULL)
+        {
+            index = ullist_search<T>::find(p_node->values,
+                                           p_node->num_values, value);
+
+            if (index >= 0)
+            {
+                break;
+            }
+
+            p_prev = p_node;
+            p_node = p_node->p_next;
+        }
+
+        if (p_node != NULL)
+        {
+            value_delete(p_prev, p_node, index);
+        }
+    }
+
+    /**
+     * @brief Find first occurrence of value.
+     *
+     * @param[in] value: Value.
+     *
+     * @retval NULL if value not found.
+     * @retval Pointer to value.
+     */
+    T *find(T value)
+    {
+        ullist_node<T> *p_node;
+
+        int index;
+
+        p_node = p_head;
+
+        while (p_node != NULL)
+        {
+            index = ullist_search<T>::find(p_node->values,
+                                           p_node->num_values, value);
+
+            if (index >= 0)
+            {
+                return &p_node->values[index];
+            }
+
+            p_node = p_node->p_next;
+        }
+
+        return NULL;
+    }
+
+    ullist_node<T> *p_head; ///< pointer to head node
+
+private:
+
+    /**
+     * @brief Create (empty) node.
+     *
+     * Nodes are aligned to cache line boundaries, so that a node occupies
+     * exactly ULLIST_NODE_SIZE / ULLIST_CACHE_LINE_SIZE cache lines.
+     *
+     * @retval Pointer to new node structure.
+     */
+    ullist_node<T> *node_create()
+    {
+        ullist_node<T> *p_node = NULL;
+
+        void *p_memory = NULL;
+
+        if (posix_memalign(&p_memory, ULLIST_CACHE_LINE_SIZE,
+                           sizeof(ullist_node<T>)) != 0)
+        {
+            throw std::bad_alloc();
+        }
+
+        p_node = new (p_memory) ullist_node<T>;
+
+        p_node->num_values = 0;
+
+        p_node->p_next = NULL;
+
+        return p_node;
+    }
+
+    /**
+     * @brief Delete node.
+     *
+     * @param[in,out] p_node: Pointer to node structure.
+     */
+    void node_delete(ullist_node<T> *p_node)
+    {
+        p_node->~ullist_node<T>();
+
+        free(p_node);
+    }
+
+    /**
+     * @brief Delete value from node; unlink & delete node if it becomes empty,
+     *        or merge it with it's successor if both fit into one node.
+     *
+     * @param[in,out] p_prev: Pointer to predecessor of node (NULL if node is
+     *                        head node).
+     * @param[in,out] p_node: Pointer to node structure.
+     * @param[in]     index:  Index of value within node.
+     */
+    void value_delete(ullist_node<T> *p_prev, ullist_node<T> *p_node,
+                      int index)
+    {
+        ullist_node<T> *p_next;
+
+        int ii;
+
+        for (ii = index; ii < p_node->num_values - 1; ii++)
+        {
+            p_node->values[ii] = p_node->values[ii + 1];
+        }
+
+        p_node->num_values--;
+
+        num_values--;
+
+        p_next = p_node->p_next;
+
+        if (p_node->num_values == 0)
+        {
+            if (p_prev != NULL)
+            {
+                p_prev->p_next = p_next;
+            }
+            else
+            {
+                p_head = p_next;
+            }
+
+            if (p_node == p_tail)
+            {
+                p_tail = p_prev;
+            }
+
+            node_delete(p_node);
+        }
+        else if ((p_next != NULL) &&
+                 (p_node->num_values < ullist_node<T>::capacity / 2) &&
+                 (p_node->num_values + p_next->num_values <=
+                  ullist_node<T>::capacity))
+        {
+            for (ii = 0; ii < p_next->num_values; ii++)
+            {
+                p_node->values[p_node->num_values + ii] = p_next->values[ii];
+            }
+
+            p_node->num_values += p_next->num_values;
+
+            p_node->p_next = p_next->p_next;
+
+            if (p_next == p_tail)
+            {
+                p_tail = p_node;
+            }
+
+            node_delete(p_next);
+        }
+    }
+
+    ullist_node<T> *p_tail; ///< pointer to tail node
+
+    int num_values; ///< number of values in list
+};
+
+#endif // #ifndef _ULLIST_H_